@@ -0,0 +1,2 @@
+-- List a container holding many small blobs, dominated by the listing requests
+SELECT count(*) FROM glob('az://benchmark/many/*.csv');
@@ -0,0 +1,2 @@
+-- Read 1000 small blobs, dominated by the per file cost (open, first read)
+SELECT count(*) FROM read_csv('az://benchmark/many/part-000???.csv');
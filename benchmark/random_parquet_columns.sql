@@ -0,0 +1,2 @@
+-- Read 2 of the 16 columns of a Parquet blob with many row groups, i.e. many small ranged reads spread over the file
+SELECT sum(c3), max(c11) FROM 'az://benchmark/wide.parquet';
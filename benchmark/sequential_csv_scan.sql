@@ -0,0 +1,2 @@
+-- Sequential scan of a single large CSV blob, dominated by buffered sequential reads
+SELECT count(*), sum(v) FROM 'az://benchmark/sequential.csv';
@@ -0,0 +1,58 @@
+#!/bin/bash
+
+# Run the read path benchmarks of ./benchmark for several read buffer sizes and transfer concurrencies, and print the
+# median time of each combination as CSV. The data is expected to have been uploaded with
+# ./scripts/upload_benchmark_files_to_azurite.sh
+#
+# Environment:
+#   DUCKDB                           duckdb cli to use (default: ./build/release/duckdb)
+#   AZURE_STORAGE_CONNECTION_STRING  storage to benchmark (default: local Azurite)
+#   BUFFER_SIZES                     values of azure_read_buffer_size (default: 262144 1048576 4194304)
+#   CONCURRENCIES                    values of azure_read_transfer_concurrency (default: 1 4)
+#   RUNS                             runs per combination, the median is reported (default: 5)
+#   SETUP_SQL                        statements run before each benchmark (e.g. other azure_* settings)
+#   BENCHMARKS                       benchmark files to run (default: all of ./benchmark)
+
+set -e
+cd "$(dirname "${0}")/.."
+
+DUCKDB="${DUCKDB:-./build/release/duckdb}"
+AZURE_STORAGE_CONNECTION_STRING="${AZURE_STORAGE_CONNECTION_STRING:-DefaultEndpointsProtocol=http;AccountName=devstoreaccount1;AccountKey=Eby8vdM02xNOcqFlqUwJPLlmEtlCDXJ1OUzFT50uSRZ6IFsuFq2UVErCz4I6tq/K1SZFPTOtr/KBHBeksoGMGw==;BlobEndpoint=http://127.0.0.1:10000/devstoreaccount1;QueueEndpoint=http://127.0.0.1:10001/devstoreaccount1;TableEndpoint=http://127.0.0.1:10002/devstoreaccount1;}"
+BUFFER_SIZES="${BUFFER_SIZES:-262144 1048576 4194304}"
+CONCURRENCIES="${CONCURRENCIES:-1 4}"
+RUNS="${RUNS:-5}"
+SETUP_SQL="${SETUP_SQL:-}"
+BENCHMARKS="${BENCHMARKS:-$(ls benchmark/*.sql)}"
+
+# Wall time in seconds of the last statement of a duckdb invocation, as reported by `.timer on`
+run_once() {
+  "${DUCKDB}" <<SQL | grep "Run Time" | tail -n 1 | awk '{ print $5 }'
+LOAD azure;
+SET azure_storage_connection_string = '${AZURE_STORAGE_CONNECTION_STRING}';
+${SETUP_SQL}
+${1}
+.timer on
+${2}
+SQL
+}
+
+median() {
+  sort -n | awk '{ values[NR] = $1 } END { print values[int((NR + 1) / 2)] }'
+}
+
+echo "benchmark,buffer_size,concurrency,median_s"
+for benchmark in ${BENCHMARKS}; do
+  query="$(grep -v '^--' "${benchmark}")"
+  for buffer_size in ${BUFFER_SIZES}; do
+    for concurrency in ${CONCURRENCIES}; do
+      # Split each buffer in one chunk per concurrent request so the concurrency is actually used
+      chunk_size=$((buffer_size / concurrency))
+      settings="SET azure_read_buffer_size = ${buffer_size}; SET azure_read_transfer_concurrency = ${concurrency}; SET azure_read_transfer_chunk_size = ${chunk_size};"
+
+      # Warm up (connections, credentials...)
+      run_once "${settings}" "${query}" > /dev/null
+      result="$(for ((run = 0; run < RUNS; run++)); do run_once "${settings}" "${query}"; done | median)"
+      echo "$(basename "${benchmark}" .sql),${buffer_size},${concurrency},${result}"
+    done
+  done
+done
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+# Generate and upload the data used by the benchmarks of ./benchmark to a local Azurite
+# Usage: ./scripts/upload_benchmark_files_to_azurite.sh [path to duckdb cli]
+
+set -e
+cd "$(dirname "${0}")/.."
+
+DUCKDB="${1:-./build/release/duckdb}"
+MANY_FILES="${MANY_FILES:-100000}"
+
+# Default Azurite connection string (see: https://github.com/Azure/Azurite)
+conn_string="DefaultEndpointsProtocol=http;AccountName=devstoreaccount1;AccountKey=Eby8vdM02xNOcqFlqUwJPLlmEtlCDXJ1OUzFT50uSRZ6IFsuFq2UVErCz4I6tq/K1SZFPTOtr/KBHBeksoGMGw==;BlobEndpoint=http://127.0.0.1:10000/devstoreaccount1;QueueEndpoint=http://127.0.0.1:10001/devstoreaccount1;TableEndpoint=http://127.0.0.1:10002/devstoreaccount1;"
+
+data_dir="$(mktemp -d)"
+trap 'rm -rf "${data_dir}"' EXIT
+
+"${DUCKDB}" <<SQL
+COPY (SELECT i AS id, i % 97 AS k, md5(i::VARCHAR) AS s, random() AS v FROM range(4000000) t(i))
+TO '${data_dir}/sequential.csv';
+
+COPY (SELECT i AS id, i * 2 AS c1, i * 3 AS c2, i * 5 AS c3, i * 7 AS c4, i * 11 AS c5, i * 13 AS c6, i * 17 AS c7,
+             i * 19 AS c8, i * 23 AS c9, i * 29 AS c10, i * 31 AS c11, i * 37 AS c12, i * 41 AS c13, i * 43 AS c14,
+             md5(i::VARCHAR) AS c15
+      FROM range(4000000) t(i))
+TO '${data_dir}/wide.parquet' (FORMAT PARQUET, ROW_GROUP_SIZE 100000);
+SQL
+
+mkdir -p "${data_dir}/many"
+for ((i = 0; i < MANY_FILES; i++)); do
+  printf 'a,b\n%d,%d\n' "${i}" "${i}" > "$(printf '%s/many/part-%06d.csv' "${data_dir}" "${i}")"
+done
+
+az storage container create -n benchmark --connection-string "${conn_string}"
+az storage blob upload --file "${data_dir}/sequential.csv" --name sequential.csv --container-name benchmark --connection-string "${conn_string}" --overwrite
+az storage blob upload --file "${data_dir}/wide.parquet" --name wide.parquet --container-name benchmark --connection-string "${conn_string}" --overwrite
+az storage blob upload-batch --source "${data_dir}/many" --destination benchmark --destination-path many --connection-string "${conn_string}" --overwrite
@@ -67,6 +67,11 @@ AzureBlobContextState::GetBlobContainerClient(const std::string &blobContainerNa
 	return service_client.GetBlobContainerClient(blobContainerName);
 }
 
+std::function<void()> AzureBlobContextState::GetWarmUpRequest(const std::string &container) const {
+	auto container_client = GetBlobContainerClient(container);
+	return [container_client]() { container_client.GetProperties(); };
+}
+
 //////// AzureBlobStorageFileHandle ////////
 AzureBlobStorageFileHandle::AzureBlobStorageFileHandle(AzureBlobStorageFileSystem &fs, string path, FileOpenFlags flags,
                                                        const AzureReadOptions &read_options,
@@ -90,6 +95,7 @@ unique_ptr<AzureFileHandle> AzureBlobStorageFileSystem::CreateHandle(const strin
 
 	auto handle = make_uniq<AzureBlobStorageFileHandle>(*this, path, flags, storage_context->read_options,
 	                                                    std::move(blob_client));
+	handle->storage_context = std::move(storage_context);
 	if (!handle->PostConstruct()) {
 		return nullptr;
 	}
@@ -131,6 +137,7 @@ vector<string> AzureBlobStorageFileSystem::Glob(const string &path, FileOpener *
 		// Perform query
 		Azure::Storage::Blobs::ListBlobsPagedResponse res;
 		try {
+			AzureIOSlot slot(AzureIOPriority::METADATA, storage_context->query_id);
 			res = container_client.ListBlobs(options);
 		} catch (Azure::Storage::StorageException &e) {
 			throw IOException("AzureStorageFileSystem Read to %s failed with %s Reason Phrase: %s", path, e.ErrorCode,
@@ -168,6 +175,7 @@ void AzureBlobStorageFileSystem::LoadRemoteFileInfo(AzureFileHandle &handle) {
 	auto res = hfh.blob_client.GetProperties();
 	hfh.length = res.Value.BlobSize;
 	hfh.last_modified = ToTimeT(res.Value.LastModified);
+	hfh.etag = res.Value.ETag.HasValue() ? res.Value.ETag.ToString() : "";
 }
 
 bool AzureBlobStorageFileSystem::FileExists(const string &filename, optional_ptr<FileOpener> opener) {
@@ -194,12 +202,45 @@ void AzureBlobStorageFileSystem::ReadRange(AzureFileHandle &handle, idx_t file_o
 		range.Length = buffer_out_len;
 		Azure::Storage::Blobs::DownloadBlobToOptions options;
 		options.Range = range;
-		options.TransferOptions.Concurrency = afh.read_options.transfer_concurrency;
-		options.TransferOptions.InitialChunkSize = afh.read_options.transfer_chunk_size;
-		options.TransferOptions.ChunkSize = afh.read_options.transfer_chunk_size;
+		if (afh.read_options.pin_version && !afh.etag.empty()) {
+			options.AccessConditions.IfMatch = Azure::ETag(afh.etag);
+		}
+		// A single request on the calling thread, large reads are split into chunks by FetchRange so the SDK does not
+		// start threads of its own
+		options.TransferOptions.Concurrency = 1;
+		options.TransferOptions.InitialChunkSize = (int64_t)buffer_out_len;
+		options.TransferOptions.ChunkSize = (int64_t)buffer_out_len;
 		auto res = afh.blob_client.DownloadTo((uint8_t *)buffer_out, buffer_out_len, options);
 
 	} catch (const Azure::Storage::StorageException &e) {
+		if (e.StatusCode == Azure::Core::Http::HttpStatusCode::PreconditionFailed) {
+			throw FileModifiedException(afh);
+		}
+		throw IOException("AzureBlobStorageFileSystem Read to '%s' failed with %s Reason Phrase: %s", afh.path,
+		                  e.ErrorCode, e.ReasonPhrase);
+	}
+}
+
+std::unique_ptr<Azure::Core::IO::BodyStream>
+AzureBlobStorageFileSystem::OpenReadStream(AzureFileHandle &handle, idx_t file_offset, idx_t length,
+                                            const Azure::Core::Context &context) {
+	auto &afh = handle.Cast<AzureBlobStorageFileHandle>();
+	try {
+		// The body is consumed as the handle is read
+		Azure::Core::Http::HttpRange range;
+		range.Offset = (int64_t)file_offset;
+		range.Length = (int64_t)length;
+		Azure::Storage::Blobs::DownloadBlobOptions options;
+		options.Range = range;
+		if (afh.read_options.pin_version && !afh.etag.empty()) {
+			options.AccessConditions.IfMatch = Azure::ETag(afh.etag);
+		}
+		auto res = afh.blob_client.Download(options, context);
+		return std::move(res.Value.BodyStream);
+	} catch (const Azure::Storage::StorageException &e) {
+		if (e.StatusCode == Azure::Core::Http::HttpStatusCode::PreconditionFailed) {
+			throw FileModifiedException(afh);
+		}
 		throw IOException("AzureBlobStorageFileSystem Read to '%s' failed with %s Reason Phrase: %s", afh.path,
 		                  e.ErrorCode, e.ReasonPhrase);
 	}
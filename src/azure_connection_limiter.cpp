@@ -0,0 +1,62 @@
+#include "azure_connection_limiter.hpp"
+#include "duckdb/main/database.hpp"
+
+#include <chrono>
+
+namespace duckdb {
+
+shared_ptr<AzureConnectionLimiter> AzureConnectionLimiter::TryGet(optional_ptr<FileOpener> opener,
+                                                                  idx_t max_connections_per_host) {
+	auto db = FileOpener::TryGetDatabase(opener);
+	if (!db) {
+		return nullptr;
+	}
+	auto limiter = db->GetObjectCache().GetOrCreate<AzureConnectionLimiter>(ObjectType());
+	limiter->SetMaxConnectionsPerHost(max_connections_per_host);
+	return limiter;
+}
+
+static const Azure::Core::Context::Key &OpenBodyKey() {
+	static const Azure::Core::Context::Key key;
+	return key;
+}
+
+Azure::Core::Context AzureConnectionLimiter::OpenBodyContext() {
+	return Azure::Core::Context().WithValue(OpenBodyKey(), true);
+}
+
+bool AzureConnectionLimiter::IsOpenBody(const Azure::Core::Context &context) {
+	bool open_body = false;
+	return context.TryGetValue(OpenBodyKey(), open_body) && open_body;
+}
+
+void AzureConnectionLimiter::SetMaxConnectionsPerHost(idx_t max_connections) {
+	{
+		lock_guard<mutex> guard(lock);
+		max_connections_per_host = max_connections;
+	}
+	released.notify_all();
+}
+
+void AzureConnectionLimiter::Acquire(const string &host, const Azure::Core::Context &context) {
+	std::unique_lock<mutex> guard(lock);
+	// Contexts cannot be waited on, the cancellation (e.g. of a hedge whose original request got its answer, or of an
+	// attempt past its deadline) is polled
+	while (max_connections_per_host != 0 && in_use[host] >= max_connections_per_host) {
+		released.wait_for(guard, std::chrono::milliseconds(10));
+		context.ThrowIfCancelled();
+	}
+	in_use[host]++;
+}
+
+void AzureConnectionLimiter::Release(const string &host) {
+	{
+		lock_guard<mutex> guard(lock);
+		if (--in_use[host] == 0) {
+			in_use.erase(host);
+		}
+	}
+	released.notify_all();
+}
+
+} // namespace duckdb
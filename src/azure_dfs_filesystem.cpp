@@ -28,7 +28,8 @@ inline static bool IsDfsScheme(const string &fpath) {
 }
 
 static void Walk(const Azure::Storage::Files::DataLake::DataLakeFileSystemClient &fs, const std::string &path,
-                 const string &path_pattern, std::size_t end_match, std::vector<std::string> *out_result) {
+                 const string &path_pattern, std::size_t end_match, transaction_t query_id,
+                 std::vector<std::string> *out_result) {
 	auto directory_client = fs.GetDirectoryClient(path);
 
 	bool recursive = false;
@@ -45,7 +46,11 @@ static void Walk(const Azure::Storage::Files::DataLake::DataLakeFileSystemClient
 
 	Azure::Storage::Files::DataLake::ListPathsOptions options;
 	while (true) {
-		auto res = directory_client.ListPaths(recursive, options);
+		Azure::Storage::Files::DataLake::ListPathsPagedResponse res;
+		{
+			AzureIOSlot slot(AzureIOPriority::METADATA, query_id);
+			res = directory_client.ListPaths(recursive, options);
+		}
 
 		for (const auto &elt : res.Paths) {
 			if (elt.IsDirectory) {
@@ -56,7 +61,8 @@ static void Walk(const Azure::Storage::Files::DataLake::DataLakeFileSystemClient
 							continue;
 						}
 						Walk(fs, elt.Name, path_pattern,
-						     std::min(path_pattern.length(), path_pattern.find('/', end_match + 1)), out_result);
+						     std::min(path_pattern.length(), path_pattern.find('/', end_match + 1)), query_id,
+						     out_result);
 					}
 				}
 			} else {
@@ -86,6 +92,11 @@ AzureDfsContextState::GetDfsFileSystemClient(const std::string &file_system_name
 	return service_client.GetFileSystemClient(file_system_name);
 }
 
+std::function<void()> AzureDfsContextState::GetWarmUpRequest(const std::string &container) const {
+	auto file_system_client = GetDfsFileSystemClient(container);
+	return [file_system_client]() { file_system_client.GetProperties(); };
+}
+
 //////// AzureDfsContextState ////////
 AzureDfsStorageFileHandle::AzureDfsStorageFileHandle(AzureDfsStorageFileSystem &fs, string path, FileOpenFlags flags,
                                                      const AzureReadOptions &read_options,
@@ -108,6 +119,7 @@ unique_ptr<AzureFileHandle> AzureDfsStorageFileSystem::CreateHandle(const string
 
 	auto handle = make_uniq<AzureDfsStorageFileHandle>(*this, path, flags, storage_context->read_options,
 	                                                   file_system_client.GetFileClient(parsed_url.path));
+	handle->storage_context = std::move(storage_context);
 	if (!handle->PostConstruct()) {
 		return nullptr;
 	}
@@ -145,6 +157,7 @@ vector<string> AzureDfsStorageFileSystem::Glob(const string &path, FileOpener *o
 	Walk(dfs_filesystem_client, shared_path,
 	     // pattern to match
 	     azure_url.path, std::min(azure_url.path.length(), azure_url.path.find('/', index_root_dir + 1)),
+	     AzureIOScheduler::GetQueryId(opener),
 	     // output result
 	     &result);
 
@@ -168,6 +181,7 @@ void AzureDfsStorageFileSystem::LoadRemoteFileInfo(AzureFileHandle &handle) {
 	auto res = hfh.file_client.GetProperties();
 	hfh.length = res.Value.FileSize;
 	hfh.last_modified = ToTimeT(res.Value.LastModified);
+	hfh.etag = res.Value.ETag.HasValue() ? res.Value.ETag.ToString() : "";
 }
 
 void AzureDfsStorageFileSystem::ReadRange(AzureFileHandle &handle, idx_t file_offset, char *buffer_out,
@@ -180,17 +194,50 @@ void AzureDfsStorageFileSystem::ReadRange(AzureFileHandle &handle, idx_t file_of
 		range.Length = buffer_out_len;
 		Azure::Storage::Files::DataLake::DownloadFileToOptions options;
 		options.Range = range;
-		options.TransferOptions.Concurrency = afh.read_options.transfer_concurrency;
-		options.TransferOptions.InitialChunkSize = afh.read_options.transfer_chunk_size;
-		options.TransferOptions.ChunkSize = afh.read_options.transfer_chunk_size;
+		if (afh.read_options.pin_version && !afh.etag.empty()) {
+			options.AccessConditions.IfMatch = Azure::ETag(afh.etag);
+		}
+		// A single request on the calling thread, large reads are split into chunks by FetchRange so the SDK does not
+		// start threads of its own
+		options.TransferOptions.Concurrency = 1;
+		options.TransferOptions.InitialChunkSize = (int64_t)buffer_out_len;
+		options.TransferOptions.ChunkSize = (int64_t)buffer_out_len;
 		auto res = afh.file_client.DownloadTo((uint8_t *)buffer_out, buffer_out_len, options);
 
 	} catch (const Azure::Storage::StorageException &e) {
+		if (e.StatusCode == Azure::Core::Http::HttpStatusCode::PreconditionFailed) {
+			throw FileModifiedException(afh);
+		}
 		throw IOException("AzureBlobStorageFileSystem Read to '%s' failed with %s Reason Phrase: %s", afh.path,
 		                  e.ErrorCode, e.ReasonPhrase);
 	}
 }
 
+std::unique_ptr<Azure::Core::IO::BodyStream>
+AzureDfsStorageFileSystem::OpenReadStream(AzureFileHandle &handle, idx_t file_offset, idx_t length,
+                                           const Azure::Core::Context &context) {
+	auto &afh = handle.Cast<AzureDfsStorageFileHandle>();
+	try {
+		// The body is consumed as the handle is read
+		Azure::Core::Http::HttpRange range;
+		range.Offset = (int64_t)file_offset;
+		range.Length = (int64_t)length;
+		Azure::Storage::Files::DataLake::DownloadFileOptions options;
+		options.Range = range;
+		if (afh.read_options.pin_version && !afh.etag.empty()) {
+			options.AccessConditions.IfMatch = Azure::ETag(afh.etag);
+		}
+		auto res = afh.file_client.Download(options, context);
+		return std::move(res.Value.Body);
+	} catch (const Azure::Storage::StorageException &e) {
+		if (e.StatusCode == Azure::Core::Http::HttpStatusCode::PreconditionFailed) {
+			throw FileModifiedException(afh);
+		}
+		throw IOException("AzureDfsStorageFileSystem Read to '%s' failed with %s Reason Phrase: %s", afh.path,
+		                  e.ErrorCode, e.ReasonPhrase);
+	}
+}
+
 shared_ptr<AzureContextState> AzureDfsStorageFileSystem::CreateStorageContext(optional_ptr<FileOpener> opener,
                                                                               const string &path,
                                                                               const AzureParsedUrl &parsed_url) {
@@ -3,19 +3,44 @@
 #include "azure_extension.hpp"
 #include "azure_blob_filesystem.hpp"
 #include "azure_dfs_filesystem.hpp"
+#include "azure_http_log.hpp"
+#include "azure_io_executor.hpp"
+#include "azure_io_scheduler.hpp"
+#include "azure_metrics.hpp"
 #include "azure_secret.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 
 namespace duckdb {
 
+// The I/O scheduler is shared by the whole process, it only follows the explicit SETs so that the sessions left on the
+// default do not undo them
+static void SetIOMaxConcurrency(ClientContext &context, SetScope scope, Value &parameter) {
+	AzureIOScheduler::Get().SetMaxConcurrency(parameter.GetValue<uint64_t>());
+}
+
+// Same for the I/O thread pool
+static void SetIOThreads(ClientContext &context, SetScope scope, Value &parameter) {
+	AzureIOExecutor::Get().SetThreadCount(parameter.GetValue<uint64_t>());
+}
+
+static void SetIOThreadPinning(ClientContext &context, SetScope scope, Value &parameter) {
+	AzureIOExecutor::Get().SetThreadPinning(parameter.GetValue<bool>());
+}
+
 static void LoadInternal(DatabaseInstance &instance) {
 	// Load filesystem
 	auto &fs = instance.GetFileSystem();
-	fs.RegisterSubSystem(make_uniq<AzureBlobStorageFileSystem>());
-	fs.RegisterSubSystem(make_uniq<AzureDfsStorageFileSystem>());
+	auto &buffer_manager = BufferManager::GetBufferManager(instance);
+	fs.RegisterSubSystem(make_uniq<AzureBlobStorageFileSystem>(buffer_manager));
+	fs.RegisterSubSystem(make_uniq<AzureDfsStorageFileSystem>(buffer_manager));
 
 	// Load Secret functions
 	CreateAzureSecretFunctions::Register(instance);
 
+	// Load table functions
+	AzureHTTPLog::RegisterFunction(instance);
+	AzureMetrics::RegisterFunctions(instance);
+
 	// Load extension config
 	auto &config = DBConfig::GetConfig(instance);
 	config.AddExtensionOption("azure_storage_connection_string",
@@ -35,6 +60,14 @@ static void LoadInternal(DatabaseInstance &instance) {
 	config.AddExtensionOption("azure_http_stats",
 	                          "Include http info from the Azure Storage in the explain analyze statement.",
 	                          LogicalType::BOOLEAN, false);
+	config.AddExtensionOption("azure_http_log_size",
+	                          "Number of recent Azure requests kept in memory and exposed by the azure_http_log() "
+	                          "table function. 0 disables the log.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_trace_file",
+	                          "File to which a span per Azure storage operation is appended in the OTLP/JSON format, "
+	                          "spans of a query share a trace id. Tracing is disabled when not set.",
+	                          LogicalType::VARCHAR, Value(nullptr));
 	config.AddExtensionOption("azure_context_caching",
 	                          "Enable/disable the caching of some context when performing queries. "
 	                          "This cache is by default enable, and will for a given connection keep a local context "
@@ -45,14 +78,90 @@ static void LoadInternal(DatabaseInstance &instance) {
 	config.AddExtensionOption("azure_transport_option_type",
 	                          "Underlying adapter to use with the Azure SDK. Read more about the adapter at "
 	                          "https://github.com/Azure/azure-sdk-for-cpp/blob/main/doc/HttpTransportAdapter.md. Valid "
-	                          "values are: default, curl",
+	                          "values are: default, curl, mock (serves the directory set in azure_mock_root, for "
+	                          "offline tests)",
 	                          LogicalType::VARCHAR, "default");
+	config.AddExtensionOption("azure_http_max_connections_per_host",
+	                          "Maximum number of concurrent requests, and therefore of open connections, to a storage "
+	                          "host shared by all the queries of the database. 0 for no limit.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_retry_max_retries",
+	                          "Maximum number of times a failed or throttled Azure request is retried.",
+	                          LogicalType::INTEGER, Value::INTEGER(3));
+	config.AddExtensionOption("azure_retry_delay_ms",
+	                          "Delay before the first retry of an Azure request, it doubles (with jitter) with each "
+	                          "retry.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(800));
+	config.AddExtensionOption("azure_retry_max_delay_ms", "Maximum delay between two retries of an Azure request.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(60000));
+	config.AddExtensionOption("azure_request_timeout_ms",
+	                          "Time after which an Azure request that has not received its response headers is "
+	                          "abandoned and retried. 0 to wait indefinitely.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_read_hedging",
+	                          "Send a duplicate of a ranged read whose response takes longer than the p95 latency of "
+	                          "the process, and use the response that arrives first. The duplicates are sent by the "
+	                          "azure_io_threads, none are sent when it is 0.",
+	                          LogicalType::BOOLEAN, false);
+	config.AddExtensionOption("azure_max_requests_per_second",
+	                          "Maximum number of requests per second sent to a storage account by the process. The "
+	                          "connections using the same rate limits share them. 0 for no limit.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_max_bytes_per_second",
+	                          "Maximum number of bytes per second transferred with a storage account by the process. "
+	                          "The connections using the same rate limits share them. 0 for no limit.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_rate_limit_adaptive",
+	                          "Halve the rate limits of a storage account when it throttles requests (429 or 503) and "
+	                          "raise them back by 5% of the limits per second without throttling.",
+	                          LogicalType::BOOLEAN, true);
+	config.AddExtensionOption("azure_io_max_concurrency",
+	                          "Maximum number of Azure operations in flight in the process. When reached, metadata "
+	                          "requests go first, then file footers, then blocking reads, then prefetches, and "
+	                          "concurrent queries get a fair share. 0 for no limit. Process-wide: setting it in any "
+	                          "connection applies to all of them.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0), SetIOMaxConcurrency);
+	config.AddExtensionOption("azure_io_threads",
+	                          "Number of threads running the Azure I/O done in the background (chunks of large reads, "
+	                          "prefetches, hedged requests, connection warm-up), shared by all the queries of the "
+	                          "process. 0 to run it on the DuckDB threads waiting for it. Process-wide: setting it in "
+	                          "any connection applies to all of them.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(AzureIOExecutor::DEFAULT_THREAD_COUNT),
+	                          SetIOThreads);
+	config.AddExtensionOption("azure_io_thread_pinning",
+	                          "Pin each Azure I/O thread to a CPU (Linux only). Process-wide, like azure_io_threads.",
+	                          LogicalType::BOOLEAN, false, SetIOThreadPinning);
+	config.AddExtensionOption("azure_warm_up_connections",
+	                          "Number of connections opened in the background when a query first accesses a storage "
+	                          "account, so that its first reads do not wait for DNS, TCP, TLS and token acquisition. "
+	                          "Requires azure_context_caching. 0 to disable.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_mock_root",
+	                          "Local directory served as the storage account by the mock transport, containers are its "
+	                          "sub directories.",
+	                          LogicalType::VARCHAR, ".");
+	config.AddExtensionOption("azure_mock_latency_ms", "Delay added by the mock transport before each response.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_mock_bandwidth",
+	                          "Maximum speed in bytes per second of the response bodies of the mock transport, 0 for "
+	                          "unlimited.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_mock_throttle_every",
+	                          "The mock transport answers every Nth request with a 503 ServerBusy, 0 to disable.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_mock_reset_every",
+	                          "The mock transport fails every Nth request with a connection reset, 0 to disable.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("azure_mock_modify_every",
+	                          "The files served by the mock transport appear modified (new last modified time and "
+	                          "ETag) to every Nth request, 0 to disable.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
 
 	AzureReadOptions default_read_options;
 	config.AddExtensionOption("azure_read_transfer_concurrency",
-	                          "Maximum number of threads the Azure client can use for a single parallel read. "
-	                          "If azure_read_transfer_chunk_size is less than azure_read_buffer_size then setting "
-	                          "this > 1 will allow the Azure client to do concurrent requests to fill the buffer.",
+	                          "Maximum number of concurrent requests used for a single read, run on the Azure I/O "
+	                          "threads. If azure_read_transfer_chunk_size is less than azure_read_buffer_size then "
+	                          "setting this > 1 will fill the buffer with concurrent requests.",
 	                          LogicalType::INTEGER, Value::INTEGER(default_read_options.transfer_concurrency));
 
 	config.AddExtensionOption("azure_read_transfer_chunk_size",
@@ -65,6 +174,35 @@ static void LoadInternal(DatabaseInstance &instance) {
 	                          "azure_read_transfer_chunk_size.",
 	                          LogicalType::UBIGINT, Value::UBIGINT(default_read_options.buffer_size));
 
+	config.AddExtensionOption("azure_read_streaming",
+	                          "Read sequentially accessed files through a single long-lived download instead of one "
+	                          "request per azure_read_buffer_size chunk. Seeks fall back to ranged requests. With "
+	                          "azure_read_prefetch_depth, each download fills half of the read-ahead buffers.",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(default_read_options.streaming));
+
+	config.AddExtensionOption("azure_read_prefetch_depth",
+	                          "Number of azure_read_buffer_size buffers fetched in the background ahead of a "
+	                          "sequentially read file. When 0, compressed files are read ahead by "
+	                          "azure_read_compressed_prefetch_depth buffers instead.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(default_read_options.prefetch_depth));
+
+	config.AddExtensionOption("azure_read_compressed_prefetch_depth",
+	                          "Number of buffers fetched in the background ahead of a compressed file (.gz, .zst) when "
+	                          "azure_read_prefetch_depth is 0, so its download overlaps with its decompression.",
+	                          LogicalType::UBIGINT, Value::UBIGINT(default_read_options.compressed_prefetch_depth));
+
+	config.AddExtensionOption("azure_read_deduplication",
+	                          "Share the identical reads (same version of a file, same range and priority) that are in "
+	                          "flight at the same time, e.g. the footer of a file opened by many threads or queries at "
+	                          "once.",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(default_read_options.deduplicate_reads));
+
+	config.AddExtensionOption("azure_read_pin_version",
+	                          "Make the reads of a file conditional on the ETag it had when it was opened (If-Match), "
+	                          "so a file overwritten during a query fails the query instead of returning a mix of two "
+	                          "versions. Disable to read files that are being appended to.",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(default_read_options.pin_version));
+
 	auto *http_proxy = std::getenv("HTTP_PROXY");
 	Value default_http_value = http_proxy ? Value(http_proxy) : Value(nullptr);
 	config.AddExtensionOption("azure_http_proxy",
@@ -1,16 +1,38 @@
 #include "azure_filesystem.hpp"
+#include "azure_connection_limiter.hpp"
+#include "azure_io_executor.hpp"
+#include "azure_metrics.hpp"
+#include "azure_single_flight.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/limits.hpp"
 #include "duckdb/common/shared_ptr.hpp"
+#include "duckdb/common/string_util.hpp"
 #include "duckdb/common/types/value.hpp"
 #include "duckdb/main/client_context.hpp"
+#include <atomic>
+#include <chrono>
 #include <azure/storage/common/storage_exception.hpp>
 
 namespace duckdb {
 
+static bool IsCompressedFile(const string &path) {
+	return StringUtil::EndsWith(path, ".gz") || StringUtil::EndsWith(path, ".zst") ||
+	       StringUtil::EndsWith(path, ".zstd");
+}
+
 AzureContextState::AzureContextState(const AzureReadOptions &read_options)
     : read_options(read_options), is_valid(true) {
 }
 
+AzureContextState::~AzureContextState() {
+	// The warm-up requests still queued are not needed anymore, the ones in flight are waited for
+	for (auto &request : warm_up_requests) {
+		if (!request->Cancel()) {
+			request->Wait();
+		}
+	}
+}
+
 bool AzureContextState::IsValid() const {
 	return is_valid;
 }
@@ -19,18 +41,188 @@ void AzureContextState::QueryEnd() {
 	is_valid = false;
 }
 
+bool AzureContextState::TryGetFileMetadata(const string &path, AzureFileMetadata &result) {
+	lock_guard<mutex> guard(file_metadata_lock);
+	auto entry = file_metadata.find(path);
+	if (entry == file_metadata.end()) {
+		return false;
+	}
+	result = entry->second;
+	return true;
+}
+
+void AzureContextState::SetFileMetadata(const string &path, const AzureFileMetadata &metadata) {
+	lock_guard<mutex> guard(file_metadata_lock);
+	file_metadata[path] = metadata;
+}
+
+void AzureContextState::WarmUp(const string &container, idx_t connection_count) {
+	if (container.empty() || AzureIOExecutor::Get().ThreadCount() == 0) {
+		return;
+	}
+	for (idx_t i = 0; i < connection_count; i++) {
+		warm_up_requests.push_back(AzureIOExecutor::Get().Submit([request = GetWarmUpRequest(container)]() {
+			try {
+				request();
+			} catch (...) {
+				// e.g. anonymous access to a container whose properties are private, the connection is open anyway
+			}
+		}));
+	}
+}
+
+AzurePrefetchBatch::AzurePrefetchBatch(idx_t buffer_count) : buffer_count(buffer_count), cancelled(false) {
+}
+
+void AzurePrefetchBatch::SetFilled(idx_t count) {
+	{
+		lock_guard<mutex> guard(lock);
+		filled_count = count;
+	}
+	changed.notify_all();
+}
+
+void AzurePrefetchBatch::Finish(idx_t count, std::exception_ptr read_error) {
+	{
+		lock_guard<mutex> guard(lock);
+		filled_count = count;
+		error = std::move(read_error);
+		finished = true;
+	}
+	changed.notify_all();
+}
+
+void AzurePrefetchBatch::WaitFilled(idx_t index) {
+	std::unique_lock<mutex> guard(lock);
+	changed.wait(guard, [&]() { return filled_count > index || finished; });
+	if (filled_count > index) {
+		return;
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	throw IOException("Prefetch of an Azure read was cancelled");
+}
+
+idx_t AzurePrefetchBatch::FilledCount() {
+	lock_guard<mutex> guard(lock);
+	return filled_count;
+}
+
+idx_t AzureReadCursor::CancelPrefetches(AzureReadBufferPool &pool) {
+	idx_t wasted_bytes = 0;
+	for (auto &prefetch : prefetches) {
+		auto &batch = *prefetch.batch;
+		batch.cancelled = true;
+		if (!batch.task->Cancel()) {
+			// The background read writes into the buffers, it has to be done before they can be recycled
+			batch.task->Wait();
+			if (prefetch.batch_index < batch.FilledCount()) {
+				wasted_bytes += prefetch.length;
+			}
+		}
+		pool.Release(std::move(prefetch.buffer));
+	}
+	prefetches.clear();
+	return wasted_bytes;
+}
+
+idx_t AzureReadCursor::DiscardBuffer() {
+	auto wasted_bytes = (buffer_end - buffer_start) - MinValue(buffer_consumed, buffer_end - buffer_start);
+	buffer_consumed = 0;
+	return wasted_bytes;
+}
+
+idx_t AzureReadCursor::ReleaseBuffer(AzureReadBufferPool &pool) {
+	auto wasted_bytes = DiscardBuffer();
+	pool.Release(std::move(read_buffer));
+	read_buffer = AzureReadBuffer();
+	buffer_available = 0;
+	buffer_idx = 0;
+	buffer_start = 0;
+	buffer_end = 0;
+	return wasted_bytes;
+}
+
+idx_t AzureReadCursor::Reset(AzureReadBufferPool &pool) {
+	auto wasted_bytes = CancelPrefetches(pool);
+	read_stream.reset();
+	return wasted_bytes + ReleaseBuffer(pool);
+}
+
 AzureFileHandle::AzureFileHandle(AzureStorageFileSystem &fs, string path, FileOpenFlags flags,
                                  const AzureReadOptions &read_options)
     : FileHandle(fs, std::move(path), flags), flags(flags),
       // File info
       length(0), last_modified(0),
       // Read info
-      buffer_available(0), buffer_idx(0), file_offset(0), buffer_start(0), buffer_end(0),
+      file_offset(0),
+      // Read-ahead
+      prefetch_depth(read_options.prefetch_depth),
       // Options
       read_options(read_options) {
-	if (!flags.RequireParallelAccess() && !flags.DirectIO()) {
-		read_buffer = duckdb::unique_ptr<data_t[]>(new data_t[read_options.buffer_size]);
+	if (prefetch_depth == 0 && IsCompressedFile(this->path)) {
+		// The decompression happens above this handle on the thread reading it, fetch ahead so the download of the
+		// next buffers overlaps with it
+		prefetch_depth = read_options.compressed_prefetch_depth;
+	}
+}
+
+AzureFileHandle::~AzureFileHandle() {
+	Close();
+}
+
+void AzureFileHandle::Close() {
+	auto &pool = static_cast<AzureStorageFileSystem &>(file_system).GetReadBufferPool();
+	idx_t wasted_bytes = cursor.Reset(pool);
+	{
+		lock_guard<mutex> guard(thread_cursors_lock);
+		for (auto &entry : thread_cursors) {
+			wasted_bytes += entry.second->Reset(pool);
+		}
+		thread_cursors.clear();
+	}
+	AddWastedBytes(wasted_bytes);
+}
+
+void AzureFileHandle::AddWastedBytes(idx_t bytes) {
+	if (bytes == 0) {
+		return;
+	}
+	AzureMetrics::Get().bytes_wasted += bytes;
+	if (http_state) {
+		http_state->total_bytes_wasted += bytes;
 	}
+	if (io_stats) {
+		io_stats->bytes_wasted += bytes;
+	}
+}
+
+transaction_t AzureFileHandle::QueryId() const {
+	return storage_context ? storage_context->query_id : MAXIMUM_QUERY_ID;
+}
+
+bool AzureFileHandle::InitializeReadBuffer(AzureReadCursor &read_cursor) {
+	if (read_cursor.read_buffer.IsValid()) {
+		return true;
+	}
+	auto &fs = static_cast<AzureStorageFileSystem &>(file_system);
+	read_cursor.read_buffer = fs.GetReadBufferPool().TryAcquire(read_options.buffer_size);
+	return read_cursor.read_buffer.IsValid();
+}
+
+AzureReadCursor &AzureFileHandle::GetThreadCursor() {
+	lock_guard<mutex> guard(thread_cursors_lock);
+	auto &thread_cursor = thread_cursors[std::this_thread::get_id()];
+	if (!thread_cursor) {
+		thread_cursor = make_uniq<AzureReadCursor>();
+		// The first read of a thread never continues a previous one, even at offset 0
+		thread_cursor->sequential_read_end = NumericLimits<idx_t>::Maximum();
+	}
+	return *thread_cursor;
+}
+
+AzureStorageFileSystem::AzureStorageFileSystem(BufferManager &buffer_manager) : read_buffer_pool(buffer_manager) {
 }
 
 bool AzureFileHandle::PostConstruct() {
@@ -39,7 +231,18 @@ bool AzureFileHandle::PostConstruct() {
 
 bool AzureStorageFileSystem::LoadFileInfo(AzureFileHandle &handle) {
 	if (handle.flags.OpenForReading()) {
+		AzureFileMetadata metadata;
+		if (handle.storage_context && handle.storage_context->TryGetFileMetadata(handle.path, metadata)) {
+			handle.length = metadata.length;
+			handle.last_modified = metadata.last_modified;
+			handle.etag = metadata.etag;
+			AzureMetrics::Get().metadata_cache_hits++;
+			return true;
+		}
+		AzureMetrics::Get().metadata_cache_misses++;
+
 		try {
+			AzureIOSlot slot(AzureIOPriority::METADATA, handle.QueryId());
 			LoadRemoteFileInfo(handle);
 		} catch (const Azure::Storage::StorageException &e) {
 			auto status_code = int(e.StatusCode);
@@ -55,6 +258,13 @@ bool AzureStorageFileSystem::LoadFileInfo(AzureFileHandle &handle) {
 			    "the credentials used were wrong. Original error message: '%s' ",
 			    handle.path, e.what());
 		}
+
+		if (handle.storage_context) {
+			metadata.length = handle.length;
+			metadata.last_modified = handle.last_modified;
+			metadata.etag = handle.etag;
+			handle.storage_context->SetFileMetadata(handle.path, metadata);
+		}
 	}
 	return true;
 }
@@ -68,6 +278,15 @@ unique_ptr<FileHandle> AzureStorageFileSystem::OpenFile(const string &path, File
 	}
 
 	auto handle = CreateHandle(path, flags, opener);
+	if (handle) {
+		Value value;
+		if (FileOpener::TryGetCurrentSetting(opener, "azure_http_stats", value) && value.GetValue<bool>()) {
+			handle->http_state = AzureHTTPState::TryGetState(opener);
+			if (handle->http_state) {
+				handle->io_stats = handle->http_state->GetFileStats(handle->path);
+			}
+		}
+	}
 	return std::move(handle);
 }
 
@@ -90,70 +309,439 @@ void AzureStorageFileSystem::FileSync(FileHandle &handle) {
 	throw NotImplementedException("FileSync for Azure Storage files not implemented");
 }
 
-// TODO: this code is identical to HTTPFS, look into unifying it
 void AzureStorageFileSystem::Read(FileHandle &handle, void *buffer, int64_t nr_bytes, idx_t location) {
 	auto &hfh = handle.Cast<AzureFileHandle>();
+	if (!hfh.http_state) {
+		ReadInternal(hfh, (char *)buffer, nr_bytes, location);
+		return;
+	}
+	auto start = std::chrono::steady_clock::now();
+	ReadInternal(hfh, (char *)buffer, nr_bytes, location);
+	hfh.http_state->AddBlockedTime(
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
 
-	idx_t to_read = nr_bytes;
-	idx_t buffer_offset = 0;
-
+void AzureStorageFileSystem::ReadInternal(AzureFileHandle &hfh, char *buffer, idx_t nr_bytes, idx_t location) {
 	// Don't buffer when DirectIO is set.
-	if (hfh.flags.DirectIO() || hfh.flags.RequireParallelAccess()) {
-		if (to_read == 0) {
+	if (hfh.flags.DirectIO()) {
+		if (nr_bytes == 0) {
 			return;
 		}
-		ReadRange(hfh, location, (char *)buffer, to_read);
-		hfh.buffer_available = 0;
-		hfh.buffer_idx = 0;
+		if (hfh.io_stats) {
+			hfh.io_stats->bytes_read += nr_bytes;
+		}
+		FetchRange(hfh, location, buffer, nr_bytes);
 		hfh.file_offset = location + nr_bytes;
 		return;
 	}
 
-	if (location >= hfh.buffer_start && location < hfh.buffer_end) {
-		hfh.file_offset = location;
-		hfh.buffer_idx = location - hfh.buffer_start;
-		hfh.buffer_available = (hfh.buffer_end - hfh.buffer_start) - hfh.buffer_idx;
+	if (hfh.flags.RequireParallelAccess()) {
+		// Each thread gets its own cursor, it is only used once the thread reads sequentially (e.g. a thread scanning
+		// its own byte range of the file), random accesses are read directly
+		auto &cursor = hfh.GetThreadCursor();
+		hfh.file_offset = location + nr_bytes;
+		bool in_buffer = location >= cursor.buffer_start && location < cursor.buffer_end;
+		if (location == cursor.sequential_read_end) {
+			cursor.sequential_read_count++;
+		} else if (!in_buffer) {
+			cursor.sequential_read_count = 1;
+		}
+		if (!in_buffer && cursor.sequential_read_count <= DIRECT_SEQUENTIAL_READS) {
+			if (nr_bytes == 0) {
+				return;
+			}
+			// The thread does not read sequentially (anymore), what the cursor holds is of no use
+			hfh.AddWastedBytes(cursor.Reset(read_buffer_pool));
+			if (hfh.io_stats) {
+				hfh.io_stats->bytes_read += nr_bytes;
+			}
+			FetchRange(hfh, location, buffer, nr_bytes);
+			cursor.sequential_read_end = location + nr_bytes;
+			return;
+		}
+		ReadBuffered(hfh, cursor, buffer, nr_bytes, location);
+		if (cursor.buffer_available == 0 && cursor.prefetches.empty()) {
+			// Everything buffered has been read, the buffer goes back to the pool until the thread reads on
+			hfh.AddWastedBytes(cursor.ReleaseBuffer(read_buffer_pool));
+		}
+		return;
+	}
+
+	ReadBuffered(hfh, hfh.cursor, buffer, nr_bytes, location);
+	hfh.file_offset = location + nr_bytes;
+}
+
+// TODO: this code is identical to HTTPFS, look into unifying it
+void AzureStorageFileSystem::ReadBuffered(AzureFileHandle &hfh, AzureReadCursor &cursor, char *buffer,
+                                          idx_t nr_bytes, idx_t location) {
+	idx_t to_read = nr_bytes;
+	idx_t buffer_offset = 0;
+	// Set once this read had to wait for a request, the bytes copied after that were not served from the buffer
+	bool fetched = false;
+	if (hfh.io_stats) {
+		hfh.io_stats->bytes_read += nr_bytes;
+	}
+
+	if (location >= cursor.buffer_start && location < cursor.buffer_end) {
+		cursor.file_offset = location;
+		cursor.buffer_idx = location - cursor.buffer_start;
+		cursor.buffer_available = (cursor.buffer_end - cursor.buffer_start) - cursor.buffer_idx;
 	} else {
 		// reset buffer
-		hfh.buffer_available = 0;
-		hfh.buffer_idx = 0;
-		hfh.file_offset = location;
+		cursor.buffer_available = 0;
+		cursor.buffer_idx = 0;
+		cursor.file_offset = location;
 	}
 	while (to_read > 0) {
-		auto buffer_read_len = MinValue<idx_t>(hfh.buffer_available, to_read);
+		auto buffer_read_len = MinValue<idx_t>(cursor.buffer_available, to_read);
 		if (buffer_read_len > 0) {
-			D_ASSERT(hfh.buffer_start + hfh.buffer_idx + buffer_read_len <= hfh.buffer_end);
-			memcpy((char *)buffer + buffer_offset, hfh.read_buffer.get() + hfh.buffer_idx, buffer_read_len);
+			D_ASSERT(cursor.buffer_start + cursor.buffer_idx + buffer_read_len <= cursor.buffer_end);
+			memcpy(buffer + buffer_offset, cursor.read_buffer.Ptr() + cursor.buffer_idx, buffer_read_len);
+			if (hfh.io_stats && !fetched) {
+				hfh.io_stats->bytes_served_from_buffer += buffer_read_len;
+			}
+			cursor.buffer_consumed = MaxValue(cursor.buffer_consumed, cursor.buffer_idx + buffer_read_len);
 
 			buffer_offset += buffer_read_len;
 			to_read -= buffer_read_len;
 
-			hfh.buffer_idx += buffer_read_len;
-			hfh.buffer_available -= buffer_read_len;
-			hfh.file_offset += buffer_read_len;
+			cursor.buffer_idx += buffer_read_len;
+			cursor.buffer_available -= buffer_read_len;
+			cursor.file_offset += buffer_read_len;
 		}
 
-		if (to_read > 0 && hfh.buffer_available == 0) {
-			auto new_buffer_available = MinValue<idx_t>(hfh.read_options.buffer_size, hfh.length - hfh.file_offset);
+		if (to_read > 0 && cursor.buffer_available == 0) {
+			if (ReadFromPrefetch(hfh, cursor)) {
+				continue;
+			}
+
+			auto new_buffer_available = MinValue<idx_t>(hfh.read_options.buffer_size, hfh.length - cursor.file_offset);
+			fetched = true;
 
-			// Bypass buffer if we read more than buffer size
-			if (to_read > new_buffer_available) {
-				ReadRange(hfh, location + buffer_offset, (char *)buffer + buffer_offset, to_read);
-				hfh.buffer_available = 0;
-				hfh.buffer_idx = 0;
-				hfh.file_offset += to_read;
+			// Bypass buffer if we read more than buffer size or if the memory limit does not allow us to buffer
+			if (to_read > new_buffer_available || !hfh.InitializeReadBuffer(cursor)) {
+				ReadSequential(hfh, cursor, location + buffer_offset, buffer + buffer_offset, to_read);
+				cursor.buffer_available = 0;
+				cursor.buffer_idx = 0;
+				cursor.file_offset += to_read;
 				break;
 			} else {
-				ReadRange(hfh, hfh.file_offset, (char *)hfh.read_buffer.get(), new_buffer_available);
-				hfh.buffer_available = new_buffer_available;
-				hfh.buffer_idx = 0;
-				hfh.buffer_start = hfh.file_offset;
-				hfh.buffer_end = hfh.buffer_start + new_buffer_available;
+				bool is_sequential = cursor.file_offset == cursor.sequential_read_end;
+				hfh.AddWastedBytes(cursor.DiscardBuffer());
+				ReadSequential(hfh, cursor, cursor.file_offset, (char *)cursor.read_buffer.Ptr(),
+				               new_buffer_available);
+				cursor.buffer_available = new_buffer_available;
+				cursor.buffer_idx = 0;
+				cursor.buffer_start = cursor.file_offset;
+				cursor.buffer_end = cursor.buffer_start + new_buffer_available;
+				if (is_sequential) {
+					SchedulePrefetches(hfh, cursor);
+				}
 			}
 		}
 	}
 }
 
+void AzureStorageFileSystem::ReadSequential(AzureFileHandle &handle, AzureReadCursor &cursor, idx_t file_offset,
+                                            char *buffer_out, idx_t buffer_out_len) {
+	if (!handle.read_options.streaming || handle.prefetch_depth > 0) {
+		// Prefetches read ahead of the cursor, streamed by batches when streaming is set
+		FetchRange(handle, file_offset, buffer_out, buffer_out_len);
+		cursor.sequential_read_end = file_offset + buffer_out_len;
+		return;
+	}
+
+	if (cursor.read_stream && cursor.read_stream_offset != file_offset) {
+		// The cursor has been seeked, the remaining of the stream is useless
+		cursor.read_stream.reset();
+	}
+	if (!cursor.read_stream) {
+		if (file_offset != cursor.sequential_read_end) {
+			// Random access, stick to a ranged read until the cursor is read sequentially again
+			FetchRange(handle, file_offset, buffer_out, buffer_out_len);
+			cursor.sequential_read_end = file_offset + buffer_out_len;
+			return;
+		}
+		{
+			AzureIOSlot slot(AzureIOPriority::READ, handle.QueryId());
+			// The stream stays open between the reads of the cursor, it must not keep a connection slot meanwhile
+			cursor.read_stream = OpenReadStream(handle, file_offset, handle.length - file_offset,
+			                                    AzureConnectionLimiter::OpenBodyContext());
+		}
+		cursor.read_stream_offset = file_offset;
+		if (handle.io_stats) {
+			handle.io_stats->request_count++;
+		}
+	}
+
+	idx_t read = 0;
+	auto start = std::chrono::steady_clock::now();
+	try {
+		read = cursor.read_stream->ReadToCount((uint8_t *)buffer_out, buffer_out_len, Azure::Core::Context());
+	} catch (const std::exception &e) {
+		cursor.read_stream.reset();
+		throw IOException("AzureStorageFileSystem Read to '%s' failed while streaming: %s", handle.path, e.what());
+	}
+	if (handle.io_stats) {
+		handle.io_stats->bytes_fetched += read;
+		handle.io_stats->wait_time_us +=
+		    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+	if (read < buffer_out_len) {
+		// The stream ended early, fetch what is missing with a ranged read
+		cursor.read_stream.reset();
+		FetchRange(handle, file_offset + read, buffer_out + read, buffer_out_len - read);
+	} else {
+		cursor.read_stream_offset += read;
+	}
+	cursor.sequential_read_end = file_offset + buffer_out_len;
+}
+
+bool AzureStorageFileSystem::ReadFromPrefetch(AzureFileHandle &handle, AzureReadCursor &cursor) {
+	if (cursor.prefetches.empty()) {
+		return false;
+	}
+	if (cursor.prefetches.front().offset != cursor.file_offset) {
+		// The cursor has been seeked, what was fetched ahead is useless
+		handle.AddWastedBytes(cursor.CancelPrefetches(read_buffer_pool));
+		return false;
+	}
+
+	auto &batch = *cursor.prefetches.front().batch;
+	if (batch.buffer_count > 1 && AzureIOExecutor::Get().ThreadCount() > 0 && batch.task->Cancel()) {
+		// The I/O threads have not started the streamed read yet, reading the whole batch here would delay this read
+		handle.AddWastedBytes(cursor.CancelPrefetches(read_buffer_pool));
+		return false;
+	}
+	// Runs here if the executor has not started it yet. Without I/O threads nobody else ever would: cancelling it
+	// would read the same bytes twice
+	batch.task->TryRun();
+
+	auto prefetch = std::move(cursor.prefetches.front());
+	cursor.prefetches.pop_front();
+	try {
+		prefetch.batch->WaitFilled(prefetch.batch_index);
+	} catch (...) {
+		read_buffer_pool.Release(std::move(prefetch.buffer));
+		handle.AddWastedBytes(cursor.CancelPrefetches(read_buffer_pool));
+		throw;
+	}
+
+	handle.AddWastedBytes(cursor.DiscardBuffer());
+	read_buffer_pool.Release(std::move(cursor.read_buffer));
+	cursor.read_buffer = std::move(prefetch.buffer);
+	cursor.buffer_available = prefetch.length;
+	cursor.buffer_idx = 0;
+	cursor.buffer_start = prefetch.offset;
+	cursor.buffer_end = prefetch.offset + prefetch.length;
+	cursor.sequential_read_end = cursor.buffer_end;
+
+	SchedulePrefetches(handle, cursor);
+	return true;
+}
+
+void AzureStorageFileSystem::SchedulePrefetches(AzureFileHandle &handle, AzureReadCursor &cursor) {
+	auto streamed = handle.read_options.streaming;
+	if (streamed && cursor.prefetches.size() > handle.prefetch_depth / 2) {
+		// Streamed read-ahead is refilled by halves, so that each download fills several buffers
+		return;
+	}
+
+	auto next_offset = cursor.prefetches.empty() ? cursor.buffer_end
+	                                             : cursor.prefetches.back().offset + cursor.prefetches.back().length;
+	auto batch_offset = next_offset;
+	vector<std::pair<char *, idx_t>> batch_buffers;
+	while (cursor.prefetches.size() < handle.prefetch_depth && next_offset < handle.length) {
+		auto buffer = read_buffer_pool.TryAcquire(handle.read_options.buffer_size);
+		if (!buffer.IsValid()) {
+			// Memory limit reached, read ahead less
+			break;
+		}
+
+		AzurePrefetch prefetch;
+		prefetch.offset = next_offset;
+		prefetch.length = MinValue<idx_t>(handle.read_options.buffer_size, handle.length - next_offset);
+		prefetch.buffer = std::move(buffer);
+		prefetch.batch_index = batch_buffers.size();
+		batch_buffers.emplace_back((char *)prefetch.buffer.Ptr(), prefetch.length);
+
+		next_offset += prefetch.length;
+		cursor.prefetches.push_back(std::move(prefetch));
+		if (!streamed) {
+			// One ranged read per buffer
+			StartPrefetchBatch(handle, cursor, batch_offset, std::move(batch_buffers));
+			batch_offset = next_offset;
+			batch_buffers.clear();
+		}
+	}
+	if (!batch_buffers.empty()) {
+		StartPrefetchBatch(handle, cursor, batch_offset, std::move(batch_buffers));
+	}
+}
+
+void AzureStorageFileSystem::StartPrefetchBatch(AzureFileHandle &handle, AzureReadCursor &cursor, idx_t file_offset,
+                                                vector<std::pair<char *, idx_t>> buffers) {
+	auto batch = make_shared_ptr<AzurePrefetchBatch>(buffers.size());
+	AzureMetrics::Get().prefetch_count++;
+	// The batch is the last prefetches of the cursor
+	for (idx_t i = cursor.prefetches.size() - buffers.size(); i < cursor.prefetches.size(); i++) {
+		cursor.prefetches[i].batch = batch;
+	}
+	// The task keeps the batch alive until it is done, it is released once the work has run or been cancelled
+	batch->task = AzureIOExecutor::Get().Submit([this, &handle, batch, file_offset, buffers]() {
+		FillPrefetchBatch(handle, *batch, file_offset, buffers);
+	});
+}
+
+void AzureStorageFileSystem::FillPrefetchBatch(AzureFileHandle &handle, AzurePrefetchBatch &batch, idx_t file_offset,
+                                               const vector<std::pair<char *, idx_t>> &buffers) {
+	idx_t filled = 0;
+	std::exception_ptr error;
+	try {
+		if (buffers.size() == 1) {
+			FetchRange(handle, file_offset, buffers[0].first, buffers[0].second, AzureIOPriority::PREFETCH);
+			filled = 1;
+		} else {
+			AzureIOSlot slot(AzureIOPriority::PREFETCH, handle.QueryId());
+			idx_t batch_length = 0;
+			for (auto &buffer : buffers) {
+				batch_length += buffer.second;
+			}
+			auto start = std::chrono::steady_clock::now();
+			auto stream = OpenReadStream(handle, file_offset, batch_length, Azure::Core::Context());
+			idx_t request_count = 1;
+			idx_t offset = file_offset;
+			for (auto &buffer : buffers) {
+				if (batch.cancelled) {
+					break;
+				}
+				idx_t read;
+				try {
+					read = stream->ReadToCount((uint8_t *)buffer.first, buffer.second, Azure::Core::Context());
+				} catch (const std::exception &e) {
+					throw IOException("AzureStorageFileSystem Read to '%s' failed while streaming: %s", handle.path,
+					                  e.what());
+				}
+				if (read < buffer.second) {
+					// The stream ended early, fetch what is missing with a ranged read. The slot is already held,
+					// FetchRange would take another one
+					ReadRange(handle, offset + read, buffer.first + read, buffer.second - read);
+					request_count++;
+				}
+				offset += buffer.second;
+				filled++;
+				if (filled < buffers.size()) {
+					// The last buffer is handed over by Finish, once the handle is not used anymore
+					batch.SetFilled(filled);
+				}
+			}
+			stream.reset();
+			if (handle.io_stats) {
+				handle.io_stats->request_count += request_count;
+				handle.io_stats->bytes_fetched += offset - file_offset;
+				handle.io_stats->wait_time_us +=
+				    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+				        .count();
+			}
+		}
+	} catch (...) {
+		error = std::current_exception();
+	}
+	batch.Finish(filled, std::move(error));
+}
+
+void AzureStorageFileSystem::FetchRange(AzureFileHandle &handle, idx_t file_offset, char *buffer_out,
+                                        idx_t buffer_out_len, AzureIOPriority priority) {
+	if (priority == AzureIOPriority::READ && file_offset + buffer_out_len == handle.length &&
+	    buffer_out_len <= FOOTER_READ_SIZE) {
+		// e.g. the footer of a Parquet file, the file cannot be scanned before it is read
+		priority = AzureIOPriority::FOOTER;
+	}
+	if (!handle.read_options.deduplicate_reads) {
+		ScheduleReadRange(handle, file_offset, buffer_out, buffer_out_len, priority);
+		return;
+	}
+	// The ETag identifies the version of the file the handle has been opened on, the length and modification time are
+	// the best we can do without it. Reads only join a read of the same priority class: a footer read waiting on a
+	// prefetch would wait behind the whole prefetch queue of the scheduler
+	auto version = handle.etag.empty() ? std::to_string(handle.last_modified) + "\n" + std::to_string(handle.length)
+	                                   : handle.etag;
+	auto key = handle.GetUrl() + "\n" + version + "\n" + std::to_string(file_offset) + "\n" +
+	           std::to_string(buffer_out_len) + "\n" + std::to_string(static_cast<uint8_t>(priority));
+	AzureSingleFlight::Get().Read(key, buffer_out, buffer_out_len, [&]() {
+		ScheduleReadRange(handle, file_offset, buffer_out, buffer_out_len, priority);
+	});
+}
+
+void AzureStorageFileSystem::ScheduleReadRange(AzureFileHandle &handle, idx_t file_offset, char *buffer_out,
+                                               idx_t buffer_out_len, AzureIOPriority priority) {
+	AzureIOSlot slot(priority, handle.QueryId());
+	auto chunk_size = NumericCast<idx_t>(MaxValue<int64_t>(handle.read_options.transfer_chunk_size, 1));
+	auto chunk_count = (buffer_out_len + chunk_size - 1) / chunk_size;
+	auto start = std::chrono::steady_clock::now();
+	if (chunk_count <= 1 || handle.read_options.transfer_concurrency <= 1) {
+		ReadRange(handle, file_offset, buffer_out, buffer_out_len);
+		chunk_count = 1;
+	} else {
+		ReadChunks(handle, file_offset, buffer_out, buffer_out_len, chunk_size, chunk_count);
+	}
+	if (handle.io_stats) {
+		handle.io_stats->request_count += chunk_count;
+		handle.io_stats->bytes_fetched += buffer_out_len;
+		handle.io_stats->wait_time_us +=
+		    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+void AzureStorageFileSystem::ReadChunks(AzureFileHandle &handle, idx_t file_offset, char *buffer_out,
+                                        idx_t buffer_out_len, idx_t chunk_size, idx_t chunk_count) {
+	// Up to `transfer_concurrency` loops take the chunks in turn: the calling thread and tasks of the executor, the
+	// tasks that have not started when the calling thread is done run on it and find nothing left to do
+	std::atomic<idx_t> next_chunk(0);
+	std::atomic<bool> failed(false);
+	auto read_chunks = [&]() {
+		while (!failed) {
+			auto chunk = next_chunk++;
+			if (chunk >= chunk_count) {
+				return;
+			}
+			auto chunk_offset = chunk * chunk_size;
+			try {
+				ReadRange(handle, file_offset + chunk_offset, buffer_out + chunk_offset,
+				          MinValue<idx_t>(chunk_size, buffer_out_len - chunk_offset));
+			} catch (...) {
+				failed = true;
+				throw;
+			}
+		}
+	};
+
+	auto helper_count = MinValue<idx_t>(NumericCast<idx_t>(handle.read_options.transfer_concurrency), chunk_count) - 1;
+	vector<shared_ptr<AzureIOTask>> helpers;
+	for (idx_t i = 0; i < helper_count; i++) {
+		helpers.push_back(AzureIOExecutor::Get().Submit(read_chunks));
+	}
+	std::exception_ptr error;
+	try {
+		read_chunks();
+	} catch (...) {
+		error = std::current_exception();
+	}
+	// The chunks write into `buffer_out`, all of them have to be done before returning
+	for (auto &helper : helpers) {
+		try {
+			helper->Wait();
+		} catch (...) {
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
 int64_t AzureStorageFileSystem::Read(FileHandle &handle, void *buffer, int64_t nr_bytes) {
 	auto &hfh = handle.Cast<AzureFileHandle>();
 	idx_t max_read = hfh.length - hfh.file_offset;
@@ -181,10 +769,15 @@ shared_ptr<AzureContextState> AzureStorageFileSystem::GetOrCreateStorageContext(
 		result = registered_state->Get<AzureContextState>(context_key);
 		if (!result || !result->IsValid()) {
 			result = CreateStorageContext(opener, path, parsed_url);
+			result->query_id = AzureIOScheduler::GetQueryId(opener);
 			registered_state->Insert(context_key, result);
+			if (FileOpener::TryGetCurrentSetting(opener, "azure_warm_up_connections", value)) {
+				result->WarmUp(parsed_url.container, value.GetValue<uint64_t>());
+			}
 		}
 	} else {
 		result = CreateStorageContext(opener, path, parsed_url);
+		result->query_id = AzureIOScheduler::GetQueryId(opener);
 	}
 
 	return result;
@@ -208,9 +801,42 @@ AzureReadOptions AzureStorageFileSystem::ParseAzureReadOptions(optional_ptr<File
 		options.buffer_size = buffer_size_val.GetValue<idx_t>();
 	}
 
+	Value streaming_val;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_read_streaming", streaming_val)) {
+		options.streaming = streaming_val.GetValue<bool>();
+	}
+
+	Value prefetch_depth_val;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_read_prefetch_depth", prefetch_depth_val)) {
+		options.prefetch_depth = prefetch_depth_val.GetValue<idx_t>();
+	}
+
+	Value compressed_prefetch_depth_val;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_read_compressed_prefetch_depth",
+	                                     compressed_prefetch_depth_val)) {
+		options.compressed_prefetch_depth = compressed_prefetch_depth_val.GetValue<idx_t>();
+	}
+
+	Value deduplicate_reads_val;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_read_deduplication", deduplicate_reads_val)) {
+		options.deduplicate_reads = deduplicate_reads_val.GetValue<bool>();
+	}
+
+	Value pin_version_val;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_read_pin_version", pin_version_val)) {
+		options.pin_version = pin_version_val.GetValue<bool>();
+	}
+
 	return options;
 }
 
+IOException AzureStorageFileSystem::FileModifiedException(const AzureFileHandle &handle) {
+	return IOException("AzureStorageFileSystem Read to '%s' failed: the file has been modified since it was opened "
+	                   "(ETag %s), reading on would mix the content of two versions. Run the query again to read the "
+	                   "new version, or SET azure_read_pin_version = false to read files that are being appended to.",
+	                   handle.path, handle.etag);
+}
+
 time_t AzureStorageFileSystem::ToTimeT(const Azure::DateTime &dt) {
 	auto time_point = static_cast<std::chrono::system_clock::time_point>(dt);
 	return std::chrono::system_clock::to_time_t(time_point);
@@ -0,0 +1,149 @@
+#include "azure_http_log.hpp"
+#include "duckdb/common/types/value.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+shared_ptr<AzureHTTPLog> AzureHTTPLog::TryGetLog(optional_ptr<FileOpener> opener) {
+	Value value;
+	idx_t log_size = 0;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_http_log_size", value)) {
+		log_size = value.GetValue<uint64_t>();
+	}
+	if (log_size == 0) {
+		return nullptr;
+	}
+
+	auto db = FileOpener::TryGetDatabase(opener);
+	if (!db) {
+		return nullptr;
+	}
+	auto log = db->GetObjectCache().GetOrCreate<AzureHTTPLog>(ObjectType());
+	if (log) {
+		log->Resize(log_size);
+	}
+	return log;
+}
+
+void AzureHTTPLog::Add(AzureHTTPLogEntry entry) {
+	lock_guard<mutex> guard(lock);
+	if (capacity == 0) {
+		return;
+	}
+	if (entries.size() < capacity) {
+		entries.push_back(std::move(entry));
+		return;
+	}
+	entries[next_entry] = std::move(entry);
+	next_entry = (next_entry + 1) % capacity;
+}
+
+void AzureHTTPLog::Resize(idx_t new_capacity) {
+	lock_guard<mutex> guard(lock);
+	if (capacity == new_capacity) {
+		return;
+	}
+	auto ordered_entries = GetEntriesInternal();
+	if (ordered_entries.size() > new_capacity) {
+		ordered_entries.erase(ordered_entries.begin(),
+		                      ordered_entries.begin() + (ordered_entries.size() - new_capacity));
+	}
+	entries = std::move(ordered_entries);
+	next_entry = 0;
+	capacity = new_capacity;
+}
+
+vector<AzureHTTPLogEntry> AzureHTTPLog::GetEntries() {
+	lock_guard<mutex> guard(lock);
+	return GetEntriesInternal();
+}
+
+vector<AzureHTTPLogEntry> AzureHTTPLog::GetEntriesInternal() {
+	vector<AzureHTTPLogEntry> result;
+	result.reserve(entries.size());
+	for (idx_t i = 0; i < entries.size(); i++) {
+		result.push_back(entries[(next_entry + i) % entries.size()]);
+	}
+	return result;
+}
+
+struct AzureHTTPLogFunctionData : public GlobalTableFunctionState {
+	vector<AzureHTTPLogEntry> entries;
+	idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> AzureHTTPLogBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+	names.emplace_back("query_id");
+	return_types.emplace_back(LogicalType::UBIGINT);
+	names.emplace_back("method");
+	return_types.emplace_back(LogicalType::VARCHAR);
+	names.emplace_back("path");
+	return_types.emplace_back(LogicalType::VARCHAR);
+	names.emplace_back("range");
+	return_types.emplace_back(LogicalType::VARCHAR);
+	names.emplace_back("status");
+	return_types.emplace_back(LogicalType::INTEGER);
+	names.emplace_back("bytes_sent");
+	return_types.emplace_back(LogicalType::UBIGINT);
+	names.emplace_back("bytes_received");
+	return_types.emplace_back(LogicalType::UBIGINT);
+	names.emplace_back("start_time");
+	return_types.emplace_back(LogicalType::TIMESTAMP);
+	names.emplace_back("end_time");
+	return_types.emplace_back(LogicalType::TIMESTAMP);
+	names.emplace_back("thread_id");
+	return_types.emplace_back(LogicalType::UBIGINT);
+	names.emplace_back("retry");
+	return_types.emplace_back(LogicalType::INTEGER);
+	names.emplace_back("error");
+	return_types.emplace_back(LogicalType::VARCHAR);
+	return nullptr;
+}
+
+static unique_ptr<GlobalTableFunctionState> AzureHTTPLogInit(ClientContext &context, TableFunctionInitInput &input) {
+	auto result = make_uniq<AzureHTTPLogFunctionData>();
+	auto log = ObjectCache::GetObjectCache(context).Get<AzureHTTPLog>(AzureHTTPLog::ObjectType());
+	if (log) {
+		result->entries = log->GetEntries();
+	}
+	return std::move(result);
+}
+
+static Value StringOrNull(const string &value) {
+	return value.empty() ? Value() : Value(value);
+}
+
+static void AzureHTTPLogFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &data = data_p.global_state->Cast<AzureHTTPLogFunctionData>();
+	idx_t count = 0;
+	while (data.offset < data.entries.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &entry = data.entries[data.offset++];
+		idx_t col = 0;
+		output.SetValue(col++, count,
+		                entry.query_id == MAXIMUM_QUERY_ID ? Value() : Value::UBIGINT(entry.query_id));
+		output.SetValue(col++, count, Value(entry.method));
+		output.SetValue(col++, count, Value(entry.path));
+		output.SetValue(col++, count, StringOrNull(entry.range));
+		output.SetValue(col++, count, entry.status == 0 ? Value() : Value::INTEGER(entry.status));
+		output.SetValue(col++, count, Value::UBIGINT(entry.bytes_sent));
+		output.SetValue(col++, count, Value::UBIGINT(entry.bytes_received));
+		output.SetValue(col++, count, Value::TIMESTAMP(entry.start_time));
+		output.SetValue(col++, count, Value::TIMESTAMP(entry.end_time));
+		output.SetValue(col++, count, Value::UBIGINT(entry.thread_id));
+		output.SetValue(col++, count, Value::INTEGER(entry.retry));
+		output.SetValue(col++, count, StringOrNull(entry.error));
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+void AzureHTTPLog::RegisterFunction(DatabaseInstance &instance) {
+	TableFunction function("azure_http_log", {}, AzureHTTPLogFunction, AzureHTTPLogBind, AzureHTTPLogInit);
+	ExtensionUtil::RegisterFunction(instance, function);
+}
+
+} // namespace duckdb
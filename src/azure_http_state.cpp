@@ -1,9 +1,78 @@
 #include "azure_http_state.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/vector.hpp"
 #include "duckdb/main/client_context.hpp"
 #include "duckdb/main/query_profiler.hpp"
 
+#include <algorithm>
+
 namespace duckdb {
 
+AzureLatencyHistogram::AzureLatencyHistogram() {
+	Reset();
+}
+
+idx_t AzureLatencyHistogram::BucketIndex(idx_t latency_us) {
+	if (latency_us < SUB_BUCKETS) {
+		return latency_us;
+	}
+	idx_t exponent = 0;
+	while ((latency_us >> (exponent + 1)) != 0) {
+		exponent++;
+	}
+	if (exponent > MAX_EXPONENT) {
+		return BUCKET_COUNT - 1;
+	}
+	// Values in [2^exponent, 2^(exponent+1)) are split in SUB_BUCKETS buckets of equal width
+	auto sub_bucket = (latency_us >> (exponent - 2)) & (SUB_BUCKETS - 1);
+	return SUB_BUCKETS * (exponent - 1) + sub_bucket;
+}
+
+idx_t AzureLatencyHistogram::BucketUpperBound(idx_t bucket) {
+	if (bucket < SUB_BUCKETS) {
+		return bucket + 1;
+	}
+	auto exponent = bucket / SUB_BUCKETS + 1;
+	auto sub_bucket = bucket % SUB_BUCKETS;
+	auto width = idx_t(1) << (exponent - 2);
+	return (idx_t(1) << exponent) + (sub_bucket + 1) * width;
+}
+
+void AzureLatencyHistogram::Add(idx_t latency_us) {
+	buckets[BucketIndex(latency_us)]++;
+	count++;
+	sum += latency_us;
+
+	auto current_max = max.load();
+	while (latency_us > current_max && !max.compare_exchange_weak(current_max, latency_us)) {
+	}
+}
+
+void AzureLatencyHistogram::Reset() {
+	for (auto &bucket : buckets) {
+		bucket = 0;
+	}
+	count = 0;
+	sum = 0;
+	max = 0;
+}
+
+idx_t AzureLatencyHistogram::Percentile(double percentile) const {
+	idx_t total = count;
+	if (total == 0) {
+		return 0;
+	}
+	auto target = MaxValue<idx_t>(1, idx_t(percentile / 100.0 * double(total) + 0.5));
+	idx_t cumulative = 0;
+	for (idx_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+		cumulative += buckets[bucket];
+		if (cumulative >= target) {
+			return MinValue<idx_t>(BucketUpperBound(bucket), max);
+		}
+	}
+	return max;
+}
+
 void AzureHTTPState::Reset() {
 	head_count = 0;
 	get_count = 0;
@@ -11,6 +80,49 @@ void AzureHTTPState::Reset() {
 	post_count = 0;
 	total_bytes_received = 0;
 	total_bytes_sent = 0;
+	total_bytes_wasted = 0;
+
+	head_latency.Reset();
+	get_latency.Reset();
+	put_latency.Reset();
+	post_latency.Reset();
+	ttfb_latency.Reset();
+
+	attempt_count = 0;
+	retry_count = 0;
+	status_2xx_count = 0;
+	status_3xx_count = 0;
+	status_4xx_count = 0;
+	status_5xx_count = 0;
+	throttled_count = 0;
+	transport_error_count = 0;
+	attempt_time_us = 0;
+	body_time_us = 0;
+	backoff_time_us = 0;
+
+	blocked_time_us = 0;
+	{
+		lock_guard<mutex> guard(thread_blocked_time_lock);
+		thread_blocked_time_us.clear();
+	}
+
+	lock_guard<mutex> guard(file_stats_lock);
+	file_stats.clear();
+}
+
+void AzureHTTPState::AddBlockedTime(idx_t time_us) {
+	blocked_time_us += time_us;
+	lock_guard<mutex> guard(thread_blocked_time_lock);
+	thread_blocked_time_us[std::this_thread::get_id()] += time_us;
+}
+
+shared_ptr<AzureFileIOStats> AzureHTTPState::GetFileStats(const string &path) {
+	lock_guard<mutex> guard(file_stats_lock);
+	auto &entry = file_stats[path];
+	if (!entry) {
+		entry = make_shared_ptr<AzureFileIOStats>(path);
+	}
+	return entry;
 }
 
 shared_ptr<AzureHTTPState> AzureHTTPState::TryGetState(ClientContext &context) {
@@ -25,9 +137,74 @@ shared_ptr<AzureHTTPState> AzureHTTPState::TryGetState(optional_ptr<FileOpener>
 	return nullptr;
 }
 
+static string FormatLatency(idx_t latency_us) {
+	auto latency_ms = double(latency_us) / 1000.0;
+	if (latency_ms < 10) {
+		return StringUtil::Format("%.1f", latency_ms);
+	}
+	return to_string(idx_t(latency_ms + 0.5));
+}
+
+static string FormatLatencyHistogram(const string &name, const AzureLatencyHistogram &histogram) {
+	return name + ": " + FormatLatency(histogram.Percentile(50)) + "/" + FormatLatency(histogram.Percentile(90)) +
+	       "/" + FormatLatency(histogram.Percentile(99)) + "/" + FormatLatency(histogram.Max());
+}
+
+void AzureHTTPState::WriteFileStats(std::ostream &ss) {
+	constexpr idx_t TEXT_WIDTH = 35;
+
+	vector<shared_ptr<AzureFileIOStats>> files;
+	{
+		lock_guard<mutex> guard(file_stats_lock);
+		for (auto &entry : file_stats) {
+			if (entry.second->bytes_read > 0 || entry.second->request_count > 0) {
+				files.push_back(entry.second);
+			}
+		}
+	}
+	if (files.empty()) {
+		return;
+	}
+	std::sort(files.begin(), files.end(),
+	          [](const shared_ptr<AzureFileIOStats> &a, const shared_ptr<AzureFileIOStats> &b) {
+		          return a->bytes_fetched > b->bytes_fetched;
+	          });
+	if (files.size() > TOP_FILE_COUNT) {
+		files.resize(TOP_FILE_COUNT);
+	}
+
+	ss << "││                                   ││\n";
+	ss << "││" + QueryProfiler::DrawPadded("top files by bytes fetched", TEXT_WIDTH) + "││\n";
+	for (auto &file : files) {
+		// Keep the end of the path, the file name is what identifies the file
+		auto name = file->path;
+		if (name.size() > TEXT_WIDTH) {
+			name = "..." + name.substr(name.size() - (TEXT_WIDTH - 3));
+		}
+		idx_t bytes_read = file->bytes_read;
+		idx_t bytes_fetched = file->bytes_fetched;
+		idx_t hit_ratio = bytes_read == 0 ? 0 : idx_t(100.0 * double(file->bytes_served_from_buffer) / bytes_read);
+		idx_t wasted_ratio = bytes_fetched == 0 ? 0 : idx_t(100.0 * double(file->bytes_wasted) / bytes_fetched);
+		string requests = " #req: " + to_string(file->request_count) +
+		                  ", in: " + StringUtil::BytesToHumanReadableString(bytes_fetched);
+		string buffer = " hit: " + to_string(hit_ratio) + "%, wasted: " + to_string(wasted_ratio) + "%";
+		string wait = " wait: " + FormatLatency(file->wait_time_us) + " ms";
+
+		ss << "││" + QueryProfiler::DrawPadded(name, TEXT_WIDTH) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(requests, TEXT_WIDTH) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(buffer, TEXT_WIDTH) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(wait, TEXT_WIDTH) + "││\n";
+	}
+}
+
 void AzureHTTPState::WriteProfilingInformation(std::ostream &ss) {
 	string read = "in: " + StringUtil::BytesToHumanReadableString(total_bytes_received);
 	string written = "out: " + StringUtil::BytesToHumanReadableString(total_bytes_sent);
+	idx_t bytes_received = total_bytes_received;
+	idx_t wasted_percentage =
+	    bytes_received == 0 ? 0 : idx_t(100.0 * double(total_bytes_wasted) / double(bytes_received));
+	string wasted = "wasted: " + StringUtil::BytesToHumanReadableString(total_bytes_wasted) + " (" +
+	                to_string(wasted_percentage) + "%)";
 	string head = "#HEAD: " + to_string(head_count);
 	string get = "#GET: " + to_string(get_count);
 	string put = "#PUT: " + to_string(put_count);
@@ -40,10 +217,69 @@ void AzureHTTPState::WriteProfilingInformation(std::ostream &ss) {
 	ss << "││                                   ││\n";
 	ss << "││" + QueryProfiler::DrawPadded(read, TOTAL_BOX_WIDTH - 4) + "││\n";
 	ss << "││" + QueryProfiler::DrawPadded(written, TOTAL_BOX_WIDTH - 4) + "││\n";
+	ss << "││" + QueryProfiler::DrawPadded(wasted, TOTAL_BOX_WIDTH - 4) + "││\n";
 	ss << "││" + QueryProfiler::DrawPadded(head, TOTAL_BOX_WIDTH - 4) + "││\n";
 	ss << "││" + QueryProfiler::DrawPadded(get, TOTAL_BOX_WIDTH - 4) + "││\n";
 	ss << "││" + QueryProfiler::DrawPadded(put, TOTAL_BOX_WIDTH - 4) + "││\n";
 	ss << "││" + QueryProfiler::DrawPadded(post, TOTAL_BOX_WIDTH - 4) + "││\n";
+	if (ttfb_latency.Count() > 0) {
+		ss << "││                                   ││\n";
+		ss << "││" + QueryProfiler::DrawPadded("latency ms p50/p90/p99/max", TOTAL_BOX_WIDTH - 4) + "││\n";
+		const std::pair<const char *, const AzureLatencyHistogram *> histograms[] = {{"HEAD", &head_latency},
+		                                                                             {"GET", &get_latency},
+		                                                                             {"PUT", &put_latency},
+		                                                                             {"POST", &post_latency},
+		                                                                             {"TTFB", &ttfb_latency}};
+		for (auto &histogram : histograms) {
+			if (histogram.second->Count() == 0) {
+				continue;
+			}
+			ss << "││" + QueryProfiler::DrawPadded(FormatLatencyHistogram(histogram.first, *histogram.second),
+			                                       TOTAL_BOX_WIDTH - 4) +
+			          "││\n";
+		}
+	}
+	if (attempt_count > 0) {
+		string attempts = "#attempts: " + to_string(attempt_count) + " (" + to_string(retry_count) + " retries)";
+		string status = "2xx/3xx/4xx/5xx: " + to_string(status_2xx_count) + "/" + to_string(status_3xx_count) + "/" +
+		                to_string(status_4xx_count) + "/" + to_string(status_5xx_count);
+		string throttled = "#throttled: " + to_string(throttled_count);
+		string transport_errors = "#transport errors: " + to_string(transport_error_count);
+		// Share of the time spent talking to Azure that was spent waiting for the next attempt
+		idx_t total_time_us = attempt_time_us + body_time_us + backoff_time_us;
+		idx_t backoff_percentage = total_time_us == 0 ? 0 : idx_t(100.0 * double(backoff_time_us) / total_time_us);
+		string backoff =
+		    "backoff: " + FormatLatency(backoff_time_us) + " ms (" + to_string(backoff_percentage) + "% of I/O)";
+
+		ss << "││                                   ││\n";
+		ss << "││" + QueryProfiler::DrawPadded(attempts, TOTAL_BOX_WIDTH - 4) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(status, TOTAL_BOX_WIDTH - 4) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(throttled, TOTAL_BOX_WIDTH - 4) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(transport_errors, TOTAL_BOX_WIDTH - 4) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(backoff, TOTAL_BOX_WIDTH - 4) + "││\n";
+	}
+	if (blocked_time_us > 0) {
+		idx_t thread_count;
+		idx_t max_thread_time_us = 0;
+		{
+			lock_guard<mutex> guard(thread_blocked_time_lock);
+			thread_count = thread_blocked_time_us.size();
+			for (auto &entry : thread_blocked_time_us) {
+				max_thread_time_us = MaxValue(max_thread_time_us, entry.second);
+			}
+		}
+		string blocked = "blocked: " + FormatLatency(blocked_time_us) + " ms (" + to_string(thread_count) + " threads)";
+		string max_thread = "max per thread: " + FormatLatency(max_thread_time_us) + " ms";
+		string stalls = FormatLatency(attempt_time_us) + "/" + FormatLatency(body_time_us) + "/" +
+		                FormatLatency(backoff_time_us);
+
+		ss << "││                                   ││\n";
+		ss << "││" + QueryProfiler::DrawPadded(blocked, TOTAL_BOX_WIDTH - 4) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(max_thread, TOTAL_BOX_WIDTH - 4) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded("stalls ms ttfb/body/backoff", TOTAL_BOX_WIDTH - 4) + "││\n";
+		ss << "││" + QueryProfiler::DrawPadded(stalls, TOTAL_BOX_WIDTH - 4) + "││\n";
+	}
+	WriteFileStats(ss);
 	ss << "│└───────────────────────────────────┘│\n";
 	ss << "└─────────────────────────────────────┘\n";
 }
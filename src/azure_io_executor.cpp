@@ -0,0 +1,216 @@
+#include "azure_io_executor.hpp"
+
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace duckdb {
+
+AzureIOTask::AzureIOTask(std::function<void()> work_p) : work(std::move(work_p)) {
+}
+
+void AzureIOTask::TryRun() {
+	{
+		lock_guard<mutex> guard(lock);
+		if (started) {
+			return;
+		}
+		started = true;
+	}
+	std::exception_ptr work_error;
+	try {
+		work();
+	} catch (...) {
+		work_error = std::current_exception();
+	}
+	{
+		lock_guard<mutex> guard(lock);
+		// Release what the work captured as soon as it is done
+		work = nullptr;
+		error = work_error;
+		finished = true;
+	}
+	done.notify_all();
+}
+
+void AzureIOTask::Wait() {
+	TryRun();
+	std::unique_lock<mutex> guard(lock);
+	done.wait(guard, [&]() { return finished; });
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+bool AzureIOTask::Cancel() {
+	lock_guard<mutex> guard(lock);
+	if (started) {
+		return false;
+	}
+	started = true;
+	finished = true;
+	work = nullptr;
+	return true;
+}
+
+AzureIOExecutor &AzureIOExecutor::Get() {
+	static AzureIOExecutor executor;
+	return executor;
+}
+
+AzureIOExecutor::~AzureIOExecutor() {
+	SetThreadCount(0);
+}
+
+void AzureIOExecutor::SetThreadCount(idx_t new_thread_count) {
+	lock_guard<mutex> resize_guard(resize_lock);
+	vector<std::thread> removed_workers;
+	std::deque<shared_ptr<AzureIOTask>> pending;
+	std::multimap<std::chrono::steady_clock::time_point, shared_ptr<AzureIOTask>> cancelled;
+	{
+		lock_guard<mutex> guard(lock);
+		thread_count = new_thread_count;
+		while (workers.size() > thread_count) {
+			removed_workers.push_back(std::move(workers.back()));
+			workers.pop_back();
+		}
+		if (thread_count == 0) {
+			pending = std::move(queue);
+			queue.clear();
+			cancelled = std::move(delayed);
+			delayed.clear();
+		}
+	}
+	work_available.notify_all();
+	for (auto &worker : removed_workers) {
+		worker.join();
+	}
+	// Nobody is left to run them, they may not be waited for (e.g. warm-up)
+	for (auto &task : pending) {
+		task->TryRun();
+	}
+	// Their submitter cancels or waits for them, which then returns right away
+	for (auto &entry : cancelled) {
+		entry.second->Cancel();
+	}
+}
+
+void AzureIOExecutor::SetThreadPinning(bool new_pin_threads) {
+	lock_guard<mutex> guard(lock);
+	if (pin_threads != new_pin_threads) {
+		pin_threads = new_pin_threads;
+		pinning_generation++;
+	}
+	work_available.notify_all();
+}
+
+idx_t AzureIOExecutor::ThreadCount() {
+	lock_guard<mutex> guard(lock);
+	return thread_count;
+}
+
+shared_ptr<AzureIOTask> AzureIOExecutor::Submit(std::function<void()> work) {
+	auto task = make_shared_ptr<AzureIOTask>(std::move(work));
+	{
+		lock_guard<mutex> guard(lock);
+		if (thread_count == 0) {
+			// The task runs when it is waited for
+			return task;
+		}
+		StartWorkers();
+		queue.push_back(task);
+	}
+	work_available.notify_one();
+	return task;
+}
+
+shared_ptr<AzureIOTask> AzureIOExecutor::SubmitAfter(std::chrono::microseconds delay, std::function<void()> work) {
+	auto task = make_shared_ptr<AzureIOTask>(std::move(work));
+	{
+		lock_guard<mutex> guard(lock);
+		if (thread_count == 0) {
+			return task;
+		}
+		StartWorkers();
+		delayed.emplace(std::chrono::steady_clock::now() + delay, task);
+	}
+	// A waiting thread recomputes when it has to wake up
+	work_available.notify_one();
+	return task;
+}
+
+void AzureIOExecutor::StartWorkers() {
+	while (workers.size() < thread_count) {
+		workers.emplace_back(&AzureIOExecutor::WorkerLoop, this, workers.size());
+	}
+}
+
+void AzureIOExecutor::QueueDueTasks() {
+	auto now = std::chrono::steady_clock::now();
+	while (!delayed.empty() && delayed.begin()->first <= now) {
+		queue.push_back(std::move(delayed.begin()->second));
+		delayed.erase(delayed.begin());
+	}
+}
+
+void AzureIOExecutor::WorkerLoop(idx_t worker_index) {
+	idx_t applied_pinning_generation = 0;
+	bool pinned = false;
+	while (true) {
+		shared_ptr<AzureIOTask> task;
+		bool pin = pinned;
+		{
+			std::unique_lock<mutex> guard(lock);
+			while (true) {
+				if (worker_index >= thread_count) {
+					// Removed from the pool, the queued tasks are left to the remaining threads
+					return;
+				}
+				QueueDueTasks();
+				if (!queue.empty()) {
+					break;
+				}
+				if (delayed.empty()) {
+					work_available.wait(guard);
+				} else {
+					work_available.wait_until(guard, delayed.begin()->first);
+				}
+			}
+			task = std::move(queue.front());
+			queue.pop_front();
+			if (applied_pinning_generation != pinning_generation) {
+				applied_pinning_generation = pinning_generation;
+				pin = pin_threads;
+			}
+		}
+		if (pin != pinned) {
+			SetCPUAffinity(worker_index, pin);
+			pinned = pin;
+		}
+		// Tasks that have been waited for or cancelled meanwhile are skipped
+		task->TryRun();
+	}
+}
+
+void AzureIOExecutor::SetCPUAffinity(idx_t worker_index, bool pin) {
+#if defined(__linux__)
+	auto cpu_count = std::thread::hardware_concurrency();
+	if (cpu_count == 0) {
+		return;
+	}
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (idx_t cpu = 0; cpu < cpu_count && cpu < CPU_SETSIZE; cpu++) {
+		if (!pin || cpu == worker_index % cpu_count) {
+			CPU_SET(cpu, &cpu_set);
+		}
+	}
+	// Best effort, e.g. the CPU may not be available to the process
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#endif
+}
+
+} // namespace duckdb
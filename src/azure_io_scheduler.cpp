@@ -0,0 +1,98 @@
+#include "azure_io_scheduler.hpp"
+#include "azure_metrics.hpp"
+#include "duckdb/main/client_context.hpp"
+
+#include <chrono>
+
+namespace duckdb {
+
+AzureIOScheduler &AzureIOScheduler::Get() {
+	static AzureIOScheduler scheduler;
+	return scheduler;
+}
+
+transaction_t AzureIOScheduler::GetQueryId(optional_ptr<FileOpener> opener) {
+	auto client_context = FileOpener::TryGetClientContext(opener);
+	return client_context ? client_context->transaction.GetActiveQuery() : MAXIMUM_QUERY_ID;
+}
+
+void AzureIOScheduler::SetMaxConcurrency(idx_t new_max_concurrency) {
+	lock_guard<mutex> guard(lock);
+	max_concurrency = new_max_concurrency;
+	AdmitWaiters();
+}
+
+void AzureIOScheduler::Acquire(AzureIOPriority priority, transaction_t query_id) {
+	std::unique_lock<mutex> guard(lock);
+	if (max_concurrency == 0 || (running < max_concurrency && waiters.empty())) {
+		running++;
+		running_per_query[query_id]++;
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	Waiter waiter {priority, query_id, next_ticket++, false};
+	waiters.push_back(&waiter);
+	AdmitWaiters();
+	admitted.wait(guard, [&]() { return waiter.admitted; });
+	AzureMetrics::Get().io_queue_wait_us[static_cast<idx_t>(priority)] +=
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void AzureIOScheduler::Release(transaction_t query_id) {
+	lock_guard<mutex> guard(lock);
+	running--;
+	auto entry = running_per_query.find(query_id);
+	if (entry != running_per_query.end() && --entry->second == 0) {
+		running_per_query.erase(entry);
+	}
+	AdmitWaiters();
+}
+
+void AzureIOScheduler::AdmitWaiters() {
+	bool admitted_any = false;
+	while (!waiters.empty() && (max_concurrency == 0 || running < max_concurrency)) {
+		idx_t best = 0;
+		for (idx_t i = 1; i < waiters.size(); i++) {
+			auto &candidate = *waiters[i];
+			auto &current = *waiters[best];
+			if (candidate.priority != current.priority) {
+				if (candidate.priority < current.priority) {
+					best = i;
+				}
+				continue;
+			}
+			auto candidate_running = running_per_query[candidate.query_id];
+			auto current_running = running_per_query[current.query_id];
+			if (candidate_running != current_running) {
+				if (candidate_running < current_running) {
+					best = i;
+				}
+				continue;
+			}
+			if (candidate.ticket < current.ticket) {
+				best = i;
+			}
+		}
+
+		auto &waiter = *waiters[best];
+		waiters.erase(waiters.begin() + best);
+		waiter.admitted = true;
+		running++;
+		running_per_query[waiter.query_id]++;
+		admitted_any = true;
+	}
+	if (admitted_any) {
+		admitted.notify_all();
+	}
+}
+
+AzureIOSlot::AzureIOSlot(AzureIOPriority priority, transaction_t query_id) : query_id(query_id) {
+	AzureIOScheduler::Get().Acquire(priority, query_id);
+}
+
+AzureIOSlot::~AzureIOSlot() {
+	AzureIOScheduler::Get().Release(query_id);
+}
+
+} // namespace duckdb
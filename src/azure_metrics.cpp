@@ -0,0 +1,242 @@
+#include "azure_metrics.hpp"
+#include "azure_rate_limiter.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/value.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+AzureMetrics::AzureMetrics() {
+	for (auto &count : request_count) {
+		count = 0;
+	}
+	for (auto &wait : io_queue_wait_us) {
+		wait = 0;
+	}
+}
+
+AzureMetrics &AzureMetrics::Get() {
+	static AzureMetrics metrics;
+	return metrics;
+}
+
+static void AddMetric(vector<AzureMetricValue> &result, const string &name, const string &type, const string &help,
+                      const string &labels, double value) {
+	AzureMetricValue metric;
+	metric.name = name;
+	metric.type = type;
+	metric.help = help;
+	metric.labels = labels;
+	metric.value = value;
+	result.push_back(std::move(metric));
+}
+
+vector<AzureMetricValue> AzureMetrics::Snapshot() const {
+	vector<AzureMetricValue> result;
+
+	const char *method_names[METHOD_COUNT] = {"HEAD", "GET", "PUT", "POST", "OTHER"};
+	for (idx_t method = 0; method < METHOD_COUNT; method++) {
+		AddMetric(result, "azure_requests_total", "counter", "Requests sent to Azure, retries included",
+		          StringUtil::Format("method=\"%s\"", method_names[method]), double(request_count[method]));
+	}
+	AddMetric(result, "azure_retries_total", "counter", "Requests that were retries of a previous attempt", "",
+	          double(retry_count));
+	AddMetric(result, "azure_requests_in_flight", "gauge", "Requests sent whose response has not been fully received",
+	          "", double(requests_in_flight));
+
+	const char *status_help = "Responses received per status code class";
+	AddMetric(result, "azure_responses_total", "counter", status_help, "class=\"2xx\"", double(status_2xx_count));
+	AddMetric(result, "azure_responses_total", "counter", status_help, "class=\"3xx\"", double(status_3xx_count));
+	AddMetric(result, "azure_responses_total", "counter", status_help, "class=\"4xx\"", double(status_4xx_count));
+	AddMetric(result, "azure_responses_total", "counter", status_help, "class=\"5xx\"", double(status_5xx_count));
+	AddMetric(result, "azure_throttled_total", "counter", "Responses asking to slow down (429 and 503)", "",
+	          double(throttled_count));
+	AddMetric(result, "azure_transport_errors_total", "counter", "Requests that failed without a response", "",
+	          double(transport_error_count));
+	AddMetric(result, "azure_timeouts_total", "counter", "Attempts abandoned after azure_request_timeout_ms", "",
+	          double(timeout_count));
+	AddMetric(result, "azure_rate_limit_wait_seconds_total", "counter",
+	          "Time requests waited for the rate limiter of their storage account", "",
+	          double(rate_limit_wait_us) / 1000000.0);
+	AzureRateLimiter::ForEach([&](AzureRateLimiter &limiter) {
+		if (!limiter.Limits().adaptive) {
+			return;
+		}
+		AddMetric(result, "azure_rate_limit_factor", "gauge",
+		          "Fraction of the configured rates allowed by the adaptive rate limiters",
+		          StringUtil::Format("account=\"%s\",requests_per_second=\"%s\",bytes_per_second=\"%s\"",
+		                             limiter.AccountName(), to_string(limiter.Limits().requests_per_second),
+		                             to_string(limiter.Limits().bytes_per_second)),
+		          limiter.RateFactor());
+	});
+	const char *priority_names[AzureIOScheduler::PRIORITY_COUNT] = {"metadata", "footer", "read", "prefetch"};
+	for (idx_t priority = 0; priority < AzureIOScheduler::PRIORITY_COUNT; priority++) {
+		AddMetric(result, "azure_io_queue_wait_seconds_total", "counter",
+		          "Time operations waited for the I/O scheduler, per priority class",
+		          StringUtil::Format("priority=\"%s\"", priority_names[priority]),
+		          double(io_queue_wait_us[priority]) / 1000000.0);
+	}
+	AddMetric(result, "azure_deduplicated_reads_total", "counter",
+	          "Reads served by an identical read in flight instead of a request of their own", "",
+	          double(deduplicated_read_count));
+	AddMetric(result, "azure_prefetch_reads_total", "counter",
+	          "Background reads started to fill read-ahead buffers", "", double(prefetch_count));
+	AddMetric(result, "azure_hedged_requests_total", "counter", "Ranged reads for which a duplicate request was sent",
+	          "", double(hedged_request_count));
+	AddMetric(result, "azure_hedge_wins_total", "counter", "Hedged reads answered first by the duplicate request", "",
+	          double(hedge_win_count));
+	AddMetric(result, "azure_sent_bytes_total", "counter", "Bytes of request bodies sent", "", double(bytes_sent));
+	AddMetric(result, "azure_received_bytes_total", "counter", "Bytes of response bodies received", "",
+	          double(bytes_received));
+	AddMetric(result, "azure_wasted_bytes_total", "counter", "Bytes fetched in read buffers that were never read", "",
+	          double(bytes_wasted));
+
+	const char *latency_help = "Latency of the requests up to the end of their response body";
+	for (auto quantile : {0.5, 0.9, 0.99}) {
+		AddMetric(result, "azure_request_duration_seconds", "summary", latency_help,
+		          StringUtil::Format("quantile=\"%s\"", Value::DOUBLE(quantile).ToString()),
+		          double(request_latency.Percentile(quantile * 100)) / 1000000.0);
+	}
+	AddMetric(result, "azure_request_duration_seconds_sum", "summary", latency_help, "",
+	          double(request_latency.Sum()) / 1000000.0);
+	AddMetric(result, "azure_request_duration_seconds_count", "summary", latency_help, "",
+	          double(request_latency.Count()));
+
+	AddMetric(result, "azure_metadata_cache_hits_total", "counter", "File metadata served without a request", "",
+	          double(metadata_cache_hits));
+	AddMetric(result, "azure_metadata_cache_misses_total", "counter", "File metadata loaded with a request", "",
+	          double(metadata_cache_misses));
+	AddMetric(result, "azure_read_buffer_pool_hits_total", "counter", "Read buffers reused from the pool", "",
+	          double(read_buffer_pool_hits));
+	AddMetric(result, "azure_read_buffer_pool_misses_total", "counter", "Read buffers allocated", "",
+	          double(read_buffer_pool_misses));
+	return result;
+}
+
+string AzureMetrics::ToPrometheus() const {
+	string result;
+	string previous_family;
+	for (auto &metric : Snapshot()) {
+		// The `_sum` and `_count` series belong to the family of their summary
+		auto family = metric.name;
+		if (metric.type == "summary") {
+			family = "azure_request_duration_seconds";
+		}
+		if (family != previous_family) {
+			result += "# HELP " + family + " " + metric.help + "\n";
+			result += "# TYPE " + family + " " + metric.type + "\n";
+			previous_family = family;
+		}
+		result += metric.name;
+		if (!metric.labels.empty()) {
+			result += "{" + metric.labels + "}";
+		}
+		result += " " + Value::DOUBLE(metric.value).ToString() + "\n";
+	}
+	return result;
+}
+
+struct AzureMetricsFunctionData : public GlobalTableFunctionState {
+	vector<AzureMetricValue> metrics;
+	idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> AzureMetricsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+	names.emplace_back("name");
+	return_types.emplace_back(LogicalType::VARCHAR);
+	names.emplace_back("labels");
+	return_types.emplace_back(LogicalType::VARCHAR);
+	names.emplace_back("type");
+	return_types.emplace_back(LogicalType::VARCHAR);
+	names.emplace_back("value");
+	return_types.emplace_back(LogicalType::DOUBLE);
+	return nullptr;
+}
+
+static unique_ptr<GlobalTableFunctionState> AzureMetricsInit(ClientContext &context, TableFunctionInitInput &input) {
+	auto result = make_uniq<AzureMetricsFunctionData>();
+	result->metrics = AzureMetrics::Get().Snapshot();
+	return std::move(result);
+}
+
+static void AzureMetricsFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &data = data_p.global_state->Cast<AzureMetricsFunctionData>();
+	idx_t count = 0;
+	while (data.offset < data.metrics.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &metric = data.metrics[data.offset++];
+		output.SetValue(0, count, Value(metric.name));
+		output.SetValue(1, count, metric.labels.empty() ? Value() : Value(metric.labels));
+		output.SetValue(2, count, Value(metric.type));
+		output.SetValue(3, count, Value::DOUBLE(metric.value));
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+struct AzureMetricsExportBindData : public TableFunctionData {
+	string path;
+};
+
+struct AzureMetricsExportState : public GlobalTableFunctionState {
+	bool finished = false;
+};
+
+static unique_ptr<FunctionData> AzureMetricsExportBind(ClientContext &context, TableFunctionBindInput &input,
+                                                       vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<AzureMetricsExportBindData>();
+	if (input.inputs[0].IsNull()) {
+		throw InvalidInputException("azure_metrics_export: the path cannot be NULL");
+	}
+	result->path = input.inputs[0].GetValue<string>();
+
+	names.emplace_back("path");
+	return_types.emplace_back(LogicalType::VARCHAR);
+	names.emplace_back("bytes_written");
+	return_types.emplace_back(LogicalType::UBIGINT);
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> AzureMetricsExportInit(ClientContext &context,
+                                                                   TableFunctionInitInput &input) {
+	return make_uniq<AzureMetricsExportState>();
+}
+
+static void AzureMetricsExportFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &state = data_p.global_state->Cast<AzureMetricsExportState>();
+	if (state.finished) {
+		return;
+	}
+	state.finished = true;
+
+	auto &bind_data = data_p.bind_data->Cast<AzureMetricsExportBindData>();
+	auto content = AzureMetrics::Get().ToPrometheus();
+
+	// Scrapers (e.g. the node exporter textfile collector) may read the file at any time, write it aside and move it
+	// in place so they never see a partial file
+	auto &fs = FileSystem::GetFileSystem(context);
+	auto temp_path = bind_data.path + ".tmp";
+	auto handle = fs.OpenFile(temp_path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+	fs.Write(*handle, (void *)content.data(), content.size());
+	handle->Sync();
+	handle->Close();
+	fs.MoveFile(temp_path, bind_data.path);
+
+	output.SetValue(0, 0, Value(bind_data.path));
+	output.SetValue(1, 0, Value::UBIGINT(content.size()));
+	output.SetCardinality(1);
+}
+
+void AzureMetrics::RegisterFunctions(DatabaseInstance &instance) {
+	TableFunction metrics_function("azure_metrics", {}, AzureMetricsFunction, AzureMetricsBind, AzureMetricsInit);
+	ExtensionUtil::RegisterFunction(instance, metrics_function);
+
+	TableFunction export_function("azure_metrics_export", {LogicalType::VARCHAR}, AzureMetricsExportFunction,
+	                              AzureMetricsExportBind, AzureMetricsExportInit);
+	ExtensionUtil::RegisterFunction(instance, export_function);
+}
+
+} // namespace duckdb
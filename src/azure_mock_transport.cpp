@@ -0,0 +1,467 @@
+#include "azure_mock_transport.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/value.hpp"
+
+#include <algorithm>
+#include <azure/core/datetime.hpp>
+#include <azure/core/http/http.hpp>
+#include <azure/core/io/body_stream.hpp>
+#include <azure/core/url.hpp>
+#include <chrono>
+#include <map>
+#include <thread>
+
+namespace duckdb {
+
+using Azure::Core::Http::HttpMethod;
+using Azure::Core::Http::HttpStatusCode;
+using Azure::Core::Http::RawResponse;
+using Azure::Core::Http::Request;
+
+//! A response body read at most at `bandwidth` bytes per second
+class MockBodyStream : public Azure::Core::IO::BodyStream {
+public:
+	MockBodyStream(string data_p, idx_t bandwidth_p)
+	    : data(std::move(data_p)), bandwidth(bandwidth_p), start(std::chrono::steady_clock::now()) {
+	}
+
+	int64_t Length() const override {
+		return NumericCast<int64_t>(data.size());
+	}
+	void Rewind() override {
+		offset = 0;
+		start = std::chrono::steady_clock::now();
+	}
+
+private:
+	size_t OnRead(uint8_t *buffer, size_t count, Azure::Core::Context const &context) override {
+		auto read_count = MinValue<size_t>(count, data.size() - offset);
+		memcpy(buffer, data.data() + offset, read_count);
+		offset += read_count;
+		if (bandwidth > 0 && read_count > 0) {
+			// Sleep until the bytes read so far would have been received, small reads don't each pay a sleep
+			auto due = start + std::chrono::microseconds(offset * 1000000 / bandwidth);
+			std::this_thread::sleep_until(due);
+		}
+		return read_count;
+	}
+
+private:
+	string data;
+	idx_t offset = 0;
+	idx_t bandwidth;
+	std::chrono::steady_clock::time_point start;
+};
+
+AzureMockTransport::AzureMockTransport(FileSystem &fs, AzureMockTransportOptions options_p)
+    : options(std::move(options_p)), fs(fs), request_count(0) {
+}
+
+static idx_t GetUBigIntSetting(optional_ptr<FileOpener> opener, const string &name) {
+	Value value;
+	if (FileOpener::TryGetCurrentSetting(opener, name, value) && !value.IsNull()) {
+		return value.GetValue<uint64_t>();
+	}
+	return 0;
+}
+
+AzureMockTransportOptions AzureMockTransport::ParseOptions(optional_ptr<FileOpener> opener) {
+	AzureMockTransportOptions result;
+	Value value;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_mock_root", value) && !value.IsNull()) {
+		result.root = value.ToString();
+	}
+	result.latency_ms = GetUBigIntSetting(opener, "azure_mock_latency_ms");
+	result.bandwidth = GetUBigIntSetting(opener, "azure_mock_bandwidth");
+	result.throttle_every = GetUBigIntSetting(opener, "azure_mock_throttle_every");
+	result.reset_every = GetUBigIntSetting(opener, "azure_mock_reset_every");
+	result.modify_every = GetUBigIntSetting(opener, "azure_mock_modify_every");
+	return result;
+}
+
+static string FormatDate(time_t time) {
+	return Azure::DateTime(std::chrono::system_clock::from_time_t(time))
+	    .ToString(Azure::DateTime::DateFormat::Rfc1123);
+}
+
+static string XMLEscape(const string &value) {
+	string result;
+	for (auto c : value) {
+		switch (c) {
+		case '&':
+			result += "&amp;";
+			break;
+		case '<':
+			result += "&lt;";
+			break;
+		case '>':
+			result += "&gt;";
+			break;
+		case '"':
+			result += "&quot;";
+			break;
+		default:
+			result += c;
+		}
+	}
+	return result;
+}
+
+static string JSONEscape(const string &value) {
+	string result;
+	for (auto c : value) {
+		if (c == '"' || c == '\\') {
+			result += '\\';
+		}
+		result += c;
+	}
+	return result;
+}
+
+static std::unique_ptr<RawResponse> MakeResponse(HttpStatusCode status, const string &reason) {
+	auto response = std::unique_ptr<RawResponse>(new RawResponse(1, 1, status, reason));
+	response->SetHeader("x-ms-request-id", "00000000-0000-0000-0000-000000000000");
+	response->SetHeader("x-ms-version", "2023-11-03");
+	response->SetHeader("Date", FormatDate(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())));
+	return response;
+}
+
+static void SetBody(RawResponse &response, string body, const string &content_type, idx_t bandwidth) {
+	response.SetHeader("Content-Type", content_type);
+	response.SetHeader("Content-Length", to_string(body.size()));
+	response.SetBodyStream(
+	    std::unique_ptr<Azure::Core::IO::BodyStream>(new MockBodyStream(std::move(body), bandwidth)));
+}
+
+static std::unique_ptr<RawResponse> ErrorResponse(const Request &request, HttpStatusCode status, const string &reason,
+                                                  const string &code, const string &message) {
+	auto response = MakeResponse(status, reason);
+	response->SetHeader("x-ms-error-code", code);
+	if (request.GetMethod() == HttpMethod::Head) {
+		return response;
+	}
+	SetBody(*response,
+	        "<?xml version=\"1.0\" encoding=\"utf-8\"?><Error><Code>" + code + "</Code><Message>" + message +
+	            "</Message></Error>",
+	        "application/xml", 0);
+	return response;
+}
+
+//! Properties of a file in the format of the blob service
+struct MockBlobProperties {
+	idx_t size = 0;
+	time_t last_modified = 0;
+	bool is_directory = false;
+
+	//! Changes whenever the file is modified, like the ETag of a blob
+	string ETag() const {
+		return StringUtil::Format("\"0x%llX%llX\"", static_cast<unsigned long long>(last_modified),
+		                          static_cast<unsigned long long>(size));
+	}
+};
+
+static bool TryGetProperties(FileSystem &fs, const string &local_path, MockBlobProperties &result) {
+	if (fs.DirectoryExists(local_path)) {
+		result.is_directory = true;
+		return true;
+	}
+	if (!fs.FileExists(local_path)) {
+		return false;
+	}
+	auto handle = fs.OpenFile(local_path, FileFlags::FILE_FLAGS_READ);
+	result.size = NumericCast<idx_t>(fs.GetFileSize(*handle));
+	result.last_modified = fs.GetLastModifiedTime(*handle);
+	return true;
+}
+
+static void SetPropertiesHeaders(RawResponse &response, const MockBlobProperties &properties) {
+	response.SetHeader("ETag", properties.ETag());
+	response.SetHeader("Last-Modified", FormatDate(properties.last_modified));
+	response.SetHeader("x-ms-creation-time", FormatDate(properties.last_modified));
+	response.SetHeader("x-ms-blob-type", "BlockBlob");
+	response.SetHeader("x-ms-lease-state", "available");
+	response.SetHeader("x-ms-lease-status", "unlocked");
+	response.SetHeader("x-ms-server-encrypted", "true");
+	response.SetHeader("x-ms-access-tier", "Hot");
+	response.SetHeader("x-ms-access-tier-inferred", "true");
+	response.SetHeader("Accept-Ranges", "bytes");
+	if (properties.is_directory) {
+		// How hierarchical namespace accounts flag directories
+		response.SetHeader("x-ms-meta-hdi_isfolder", "true");
+		response.SetHeader("x-ms-resource-type", "directory");
+	} else {
+		response.SetHeader("x-ms-resource-type", "file");
+	}
+}
+
+static bool TryGetHeader(const Request &request, const string &name, string &result) {
+	auto headers = request.GetHeaders();
+	auto entry = headers.find(name);
+	if (entry == headers.end()) {
+		return false;
+	}
+	result = entry->second;
+	return true;
+}
+
+//! Whether a path relative to `azure_mock_root` stays under it, i.e. none of its segments goes up a directory
+static bool IsUnderRoot(const string &path) {
+	for (auto &segment : StringUtil::Split(StringUtil::Replace(path, "\\", "/"), '/')) {
+		if (segment == "..") {
+			return false;
+		}
+	}
+	return true;
+}
+
+//! Parses a "bytes=start-end" range, the end is optional
+static bool ParseRange(const string &range, idx_t &start, idx_t &end) {
+	const string prefix = "bytes=";
+	if (!StringUtil::StartsWith(range, prefix)) {
+		return false;
+	}
+	auto dash = range.find('-', prefix.size());
+	if (dash == string::npos) {
+		return false;
+	}
+	start = std::stoull(range.substr(prefix.size(), dash - prefix.size()));
+	auto end_str = range.substr(dash + 1);
+	end = end_str.empty() ? NumericLimits<idx_t>::Maximum() : std::stoull(end_str);
+	return true;
+}
+
+std::unique_ptr<RawResponse> AzureMockTransport::Send(Request &request, Azure::Core::Context const &context) {
+	auto request_number = ++request_count;
+	// Like a real transport, a request waiting for its response gives up when its context is cancelled
+	auto response_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.latency_ms);
+	while (std::chrono::steady_clock::now() < response_time) {
+		context.ThrowIfCancelled();
+		std::this_thread::sleep_for(MinValue<std::chrono::steady_clock::duration>(
+		    response_time - std::chrono::steady_clock::now(), std::chrono::milliseconds(1)));
+	}
+	context.ThrowIfCancelled();
+	if (options.reset_every > 0 && request_number % options.reset_every == 0) {
+		throw Azure::Core::Http::TransportException("Mock connection reset by peer");
+	}
+	if (options.throttle_every > 0 && request_number % options.throttle_every == 0) {
+		return ErrorResponse(request, HttpStatusCode::ServiceUnavailable, "Server Busy", "ServerBusy",
+		                     "The server is currently unable to receive requests. Please retry your request.");
+	}
+
+	auto &url = request.GetUrl();
+	auto path = Azure::Core::Url::Decode(url.GetPath());
+	auto query = url.GetQueryParameters();
+	auto container = path.substr(0, path.find('/'));
+	if (!IsUnderRoot(path)) {
+		return ErrorResponse(request, HttpStatusCode::BadRequest, "Bad Request", "InvalidUri",
+		                     "The mock transport only serves the files under azure_mock_root.");
+	}
+
+	if (request.GetMethod() != HttpMethod::Head && request.GetMethod() != HttpMethod::Get) {
+		return ErrorResponse(request, HttpStatusCode::MethodNotAllowed, "Method Not Allowed",
+		                     "UnsupportedHttpVerb", "The mock transport only serves reads.");
+	}
+	if (container.empty() || !fs.DirectoryExists(fs.JoinPath(options.root, container))) {
+		return ErrorResponse(request, HttpStatusCode::NotFound, "Not Found", "ContainerNotFound",
+		                     "The specified container does not exist.");
+	}
+	if (query.count("comp") && query["comp"] == "list") {
+		return ListBlobs(request, container);
+	}
+	if (query.count("resource") && query["resource"] == "filesystem" && request.GetMethod() == HttpMethod::Get) {
+		return ListPaths(request, container);
+	}
+	if (path == container) {
+		// Container (or file system) properties
+		auto response = MakeResponse(HttpStatusCode::Ok, "OK");
+		response->SetHeader("ETag", "\"0x0\"");
+		response->SetHeader("Last-Modified", FormatDate(0));
+		return response;
+	}
+	return GetBlob(request, path, request_number);
+}
+
+std::unique_ptr<RawResponse> AzureMockTransport::GetBlob(Request &request, const string &path, idx_t request_number) {
+	auto local_path = fs.JoinPath(options.root, path);
+	MockBlobProperties properties;
+	if (!TryGetProperties(fs, local_path, properties)) {
+		return ErrorResponse(request, HttpStatusCode::NotFound, "Not Found", "BlobNotFound",
+		                     "The specified blob does not exist.");
+	}
+	if (options.modify_every > 0 && request_number % options.modify_every == 0) {
+		// As if the file had been rewritten since the previous request
+		properties.last_modified++;
+	}
+
+	string if_match;
+	if (TryGetHeader(request, "If-Match", if_match) && if_match != "*" && if_match != properties.ETag()) {
+		return ErrorResponse(request, HttpStatusCode::PreconditionFailed, "Precondition Failed", "ConditionNotMet",
+		                     "The condition specified using HTTP conditional header(s) is not met.");
+	}
+
+	if (request.GetMethod() == HttpMethod::Head) {
+		auto response = MakeResponse(HttpStatusCode::Ok, "OK");
+		SetPropertiesHeaders(*response, properties);
+		response->SetHeader("Content-Length", to_string(properties.size));
+		response->SetHeader("Content-Type", "application/octet-stream");
+		return response;
+	}
+	if (properties.is_directory) {
+		return ErrorResponse(request, HttpStatusCode::Conflict, "Conflict", "PathIsDirectory",
+		                     "The specified path is a directory.");
+	}
+
+	idx_t start = 0;
+	idx_t end = properties.size == 0 ? 0 : properties.size - 1;
+	string range;
+	bool ranged = TryGetHeader(request, "x-ms-range", range) || TryGetHeader(request, "Range", range);
+	if (ranged) {
+		idx_t range_end;
+		if (!ParseRange(range, start, range_end) || start >= properties.size) {
+			auto response = ErrorResponse(request, HttpStatusCode::RangeNotSatisfiable, "Range Not Satisfiable",
+			                              "InvalidRange", "The range specified is invalid for the current size.");
+			response->SetHeader("Content-Range", "bytes */" + to_string(properties.size));
+			return response;
+		}
+		end = MinValue<idx_t>(range_end, end);
+	}
+
+	string body;
+	if (properties.size > 0) {
+		body.resize(end - start + 1);
+		auto handle = fs.OpenFile(fs.JoinPath(options.root, path), FileFlags::FILE_FLAGS_READ);
+		fs.Read(*handle, (void *)body.data(), NumericCast<int64_t>(body.size()), start);
+	}
+
+	auto response = ranged ? MakeResponse(HttpStatusCode::PartialContent, "Partial Content")
+	                       : MakeResponse(HttpStatusCode::Ok, "OK");
+	SetPropertiesHeaders(*response, properties);
+	if (ranged) {
+		response->SetHeader("Content-Range",
+		                    "bytes " + to_string(start) + "-" + to_string(end) + "/" + to_string(properties.size));
+	}
+	SetBody(*response, std::move(body), "application/octet-stream", options.bandwidth);
+	return response;
+}
+
+void AzureMockTransport::ListFilesRecursive(const string &directory, const string &prefix, vector<string> &result,
+                                            bool include_directories) {
+	fs.ListFiles(directory, [&](const string &name, bool is_directory) {
+		auto relative = prefix.empty() ? name : prefix + "/" + name;
+		if (is_directory) {
+			if (include_directories) {
+				result.push_back(relative);
+			}
+			ListFilesRecursive(fs.JoinPath(directory, name), relative, result, include_directories);
+		} else {
+			result.push_back(relative);
+		}
+	});
+}
+
+//! Applies the `marker` and `maxresults` paging parameters, returns the marker of the next page (empty if last)
+static string Paginate(vector<string> &names, const string &marker, idx_t max_results) {
+	std::sort(names.begin(), names.end());
+	if (!marker.empty()) {
+		names.erase(names.begin(), std::upper_bound(names.begin(), names.end(), marker));
+	}
+	if (names.size() <= max_results) {
+		return string();
+	}
+	names.resize(max_results);
+	return names.back();
+}
+
+static idx_t MaxResults(std::map<std::string, std::string> &query) {
+	if (!query.count("maxresults")) {
+		return 5000;
+	}
+	return MaxValue<idx_t>(std::stoull(query["maxresults"]), 1);
+}
+
+std::unique_ptr<RawResponse> AzureMockTransport::ListBlobs(Request &request, const string &container) {
+	auto query = request.GetUrl().GetQueryParameters();
+	auto prefix = query.count("prefix") ? Azure::Core::Url::Decode(query["prefix"]) : string();
+	auto marker = query.count("marker") ? Azure::Core::Url::Decode(query["marker"]) : string();
+
+	vector<string> names;
+	ListFilesRecursive(fs.JoinPath(options.root, container), string(), names, false);
+	names.erase(std::remove_if(names.begin(), names.end(),
+	                           [&](const string &name) { return !StringUtil::StartsWith(name, prefix); }),
+	            names.end());
+	auto next_marker = Paginate(names, marker, MaxResults(query));
+
+	string body = "<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults ServiceEndpoint=\"" +
+	              XMLEscape(request.GetUrl().GetScheme() + "://" + request.GetUrl().GetHost() + "/") +
+	              "\" ContainerName=\"" + XMLEscape(container) + "\"><Prefix>" + XMLEscape(prefix) + "</Prefix><Blobs>";
+	for (auto &name : names) {
+		MockBlobProperties properties;
+		TryGetProperties(fs, fs.JoinPath(options.root, container + "/" + name), properties);
+		body += "<Blob><Name>" + XMLEscape(name) + "</Name><Properties><Creation-Time>" +
+		        FormatDate(properties.last_modified) + "</Creation-Time><Last-Modified>" +
+		        FormatDate(properties.last_modified) + "</Last-Modified><Etag>" + XMLEscape(properties.ETag()) +
+		        "</Etag><Content-Length>" + to_string(properties.size) +
+		        "</Content-Length><Content-Type>application/octet-stream</Content-Type><BlobType>BlockBlob</BlobType>"
+		        "<AccessTier>Hot</AccessTier><AccessTierInferred>true</AccessTierInferred><LeaseStatus>unlocked"
+		        "</LeaseStatus><LeaseState>available</LeaseState><ServerEncrypted>true</ServerEncrypted></Properties>"
+		        "</Blob>";
+	}
+	body += "</Blobs><NextMarker>" + XMLEscape(next_marker) + "</NextMarker></EnumerationResults>";
+
+	auto response = MakeResponse(HttpStatusCode::Ok, "OK");
+	SetBody(*response, std::move(body), "application/xml", options.bandwidth);
+	return response;
+}
+
+std::unique_ptr<RawResponse> AzureMockTransport::ListPaths(Request &request, const string &file_system) {
+	auto query = request.GetUrl().GetQueryParameters();
+	auto directory = query.count("directory") ? Azure::Core::Url::Decode(query["directory"]) : string();
+	auto marker = query.count("continuation") ? Azure::Core::Url::Decode(query["continuation"]) : string();
+	bool recursive = query.count("recursive") && query["recursive"] == "true";
+	if (!IsUnderRoot(directory)) {
+		return ErrorResponse(request, HttpStatusCode::BadRequest, "Bad Request", "InvalidUri",
+		                     "The mock transport only serves the files under azure_mock_root.");
+	}
+
+	auto base = file_system + (directory.empty() ? "" : "/" + directory);
+	auto local_directory = fs.JoinPath(options.root, base);
+	if (!fs.DirectoryExists(local_directory)) {
+		return ErrorResponse(request, HttpStatusCode::NotFound, "Not Found", "PathNotFound",
+		                     "The specified path does not exist.");
+	}
+
+	vector<string> names;
+	if (recursive) {
+		ListFilesRecursive(local_directory, directory, names, true);
+	} else {
+		fs.ListFiles(local_directory, [&](const string &name, bool is_directory) {
+			names.push_back(directory.empty() ? name : directory + "/" + name);
+		});
+	}
+	auto next_marker = Paginate(names, marker, MaxResults(query));
+
+	string body = "{\"paths\":[";
+	for (idx_t i = 0; i < names.size(); i++) {
+		MockBlobProperties properties;
+		TryGetProperties(fs, fs.JoinPath(options.root, file_system + "/" + names[i]), properties);
+		body += i == 0 ? "" : ",";
+		body += "{\"name\":\"" + JSONEscape(names[i]) + "\",";
+		if (properties.is_directory) {
+			body += "\"isDirectory\":\"true\",";
+		}
+		body += "\"contentLength\":\"" + to_string(properties.size) + "\",\"lastModified\":\"" +
+		        FormatDate(properties.last_modified) + "\",\"etag\":\"" + JSONEscape(properties.ETag()) +
+		        "\",\"owner\":\"$superuser\",\"group\":\"$superuser\",\"permissions\":\"rw-r-----\"}";
+	}
+	body += "]}";
+
+	auto response = MakeResponse(HttpStatusCode::Ok, "OK");
+	if (!next_marker.empty()) {
+		response->SetHeader("x-ms-continuation", next_marker);
+	}
+	SetBody(*response, std::move(body), "application/json;charset=utf-8", options.bandwidth);
+	return response;
+}
+
+} // namespace duckdb
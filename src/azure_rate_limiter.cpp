@@ -0,0 +1,110 @@
+#include "azure_rate_limiter.hpp"
+#include "duckdb/common/helper.hpp"
+#include "duckdb/common/unordered_map.hpp"
+
+#include <thread>
+
+namespace duckdb {
+
+AzureRateLimiter::AzureRateLimiter(string account_name_p, const AzureRateLimits &limits)
+    : account_name(std::move(account_name_p)), limits(limits) {
+}
+
+// Limiters are never released, there is one per storage account and limits used by the process
+struct AzureRateLimiterRegistry {
+	mutex lock;
+	unordered_map<string, unique_ptr<AzureRateLimiter>> limiters;
+};
+
+static AzureRateLimiterRegistry &GetRegistry() {
+	static AzureRateLimiterRegistry registry;
+	return registry;
+}
+
+AzureRateLimiter &AzureRateLimiter::Get(const string &account_name, const AzureRateLimits &limits) {
+	auto &registry = GetRegistry();
+	auto key = account_name + "\n" + to_string(limits.requests_per_second) + "\n" +
+	           to_string(limits.bytes_per_second) + "\n" + (limits.adaptive ? "adaptive" : "fixed");
+	lock_guard<mutex> guard(registry.lock);
+	auto &limiter = registry.limiters[key];
+	if (!limiter) {
+		limiter = make_uniq<AzureRateLimiter>(account_name, limits);
+	}
+	return *limiter;
+}
+
+void AzureRateLimiter::ForEach(const std::function<void(AzureRateLimiter &)> &callback) {
+	auto &registry = GetRegistry();
+	lock_guard<mutex> guard(registry.lock);
+	for (auto &entry : registry.limiters) {
+		callback(*entry.second);
+	}
+}
+
+std::chrono::microseconds AzureRateLimiter::TokenBucket::TryTake(double cost, double rate) {
+	auto now = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::duration<double>(now - last_refill).count();
+	last_refill = now;
+	// A second worth of tokens can be accumulated, so short bursts are not delayed
+	tokens = MinValue<double>(rate, tokens + elapsed * rate);
+	if (tokens < 0) {
+		return std::chrono::microseconds(static_cast<int64_t>(-tokens / rate * 1000000) + 1);
+	}
+	// Requests larger than the burst are let through and paid for by the next ones
+	tokens -= cost;
+	return std::chrono::microseconds(0);
+}
+
+idx_t AzureRateLimiter::Acquire(idx_t bytes_count) {
+	auto start = std::chrono::steady_clock::now();
+	bool requests_taken = false;
+	while (true) {
+		std::chrono::microseconds wait(0);
+		{
+			lock_guard<mutex> guard(lock);
+			if (!requests_taken && limits.requests_per_second > 0) {
+				wait = requests.TryTake(1, double(limits.requests_per_second) * rate_factor);
+			}
+			if (wait.count() == 0) {
+				requests_taken = true;
+				if (limits.bytes_per_second > 0 && bytes_count > 0) {
+					wait = bytes.TryTake(double(bytes_count), double(limits.bytes_per_second) * rate_factor);
+				}
+			}
+		}
+		if (wait.count() == 0) {
+			break;
+		}
+		std::this_thread::sleep_for(wait);
+	}
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void AzureRateLimiter::OnResponse(int32_t status) {
+	lock_guard<mutex> guard(lock);
+	if (!limits.adaptive) {
+		return;
+	}
+	auto now = std::chrono::steady_clock::now();
+	if (status == 429 || status == 503) {
+		if (now - last_decrease > std::chrono::seconds(1)) {
+			rate_factor = MaxValue<double>(rate_factor * DECREASE_FACTOR, MINIMUM_RATE_FACTOR);
+			last_decrease = now;
+		}
+		// The time spent throttled does not count towards the recovery
+		last_increase = now;
+	} else if (status >= 200 && status < 300) {
+		if (rate_factor < 1) {
+			auto elapsed = std::chrono::duration<double>(now - last_increase).count();
+			rate_factor = MinValue<double>(rate_factor + elapsed * INCREASE_PER_SECOND, 1);
+		}
+		last_increase = now;
+	}
+}
+
+double AzureRateLimiter::RateFactor() {
+	lock_guard<mutex> guard(lock);
+	return rate_factor;
+}
+
+} // namespace duckdb
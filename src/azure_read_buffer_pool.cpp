@@ -0,0 +1,84 @@
+#include "azure_read_buffer_pool.hpp"
+#include "azure_metrics.hpp"
+#include "duckdb/common/enums/memory_tag.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+namespace duckdb {
+
+AzureReadBufferPool::AzureReadBufferPool(BufferManager &buffer_manager, idx_t max_pooled_bytes)
+    : buffer_manager(buffer_manager), pooled_bytes(0), max_pooled_bytes(max_pooled_bytes) {
+}
+
+AzureReadBuffer AzureReadBufferPool::TryReuse(idx_t size) {
+	lock_guard<mutex> guard(lock);
+	for (idx_t i = idle_buffers.size(); i > 0; i--) {
+		if (idle_buffers[i - 1].size != size) {
+			continue;
+		}
+		auto result = std::move(idle_buffers[i - 1]);
+		idle_buffers.erase(idle_buffers.begin() + (i - 1));
+		pooled_bytes -= result.size;
+		return result;
+	}
+	return AzureReadBuffer();
+}
+
+AzureReadBuffer AzureReadBufferPool::Allocate(idx_t size) {
+	AzureReadBuffer result;
+	result.handle = buffer_manager.Allocate(MemoryTag::EXTENSION, size);
+	result.size = size;
+	return result;
+}
+
+AzureReadBuffer AzureReadBufferPool::Acquire(idx_t size) {
+	auto result = TryReuse(size);
+	if (result.IsValid()) {
+		AzureMetrics::Get().read_buffer_pool_hits++;
+		return result;
+	}
+	AzureMetrics::Get().read_buffer_pool_misses++;
+
+	try {
+		return Allocate(size);
+	} catch (OutOfMemoryException &) {
+		// The idle buffers may be what is keeping us above the limit, give them back and retry once
+		Clear();
+		return Allocate(size);
+	}
+}
+
+AzureReadBuffer AzureReadBufferPool::TryAcquire(idx_t size) {
+	try {
+		return Acquire(size);
+	} catch (OutOfMemoryException &) {
+		return AzureReadBuffer();
+	}
+}
+
+void AzureReadBufferPool::Release(AzureReadBuffer buffer) {
+	if (!buffer.IsValid()) {
+		return;
+	}
+
+	lock_guard<mutex> guard(lock);
+	if (pooled_bytes + buffer.size > max_pooled_bytes) {
+		// Pool is full, let the buffer be freed
+		return;
+	}
+	pooled_bytes += buffer.size;
+	idle_buffers.push_back(std::move(buffer));
+}
+
+void AzureReadBufferPool::Clear() {
+	vector<AzureReadBuffer> to_free;
+	{
+		lock_guard<mutex> guard(lock);
+		to_free = std::move(idle_buffers);
+		idle_buffers.clear();
+		pooled_bytes = 0;
+	}
+	// Buffers are released here, outside of the lock
+}
+
+} // namespace duckdb
@@ -0,0 +1,72 @@
+#include "azure_single_flight.hpp"
+#include "azure_metrics.hpp"
+
+#include <cstring>
+
+namespace duckdb {
+
+AzureSingleFlight &AzureSingleFlight::Get() {
+	static AzureSingleFlight single_flight;
+	return single_flight;
+}
+
+bool AzureSingleFlight::Read(const string &key, char *buffer_out, idx_t buffer_out_len,
+                             const std::function<void()> &read) {
+	shared_ptr<Flight> flight;
+	bool leader = false;
+	{
+		lock_guard<mutex> guard(lock);
+		auto &entry = flights[key];
+		if (!entry) {
+			entry = make_shared_ptr<Flight>();
+			leader = true;
+		} else {
+			entry->follower_count++;
+		}
+		flight = entry;
+	}
+
+	if (!leader) {
+		std::unique_lock<mutex> guard(flight->lock);
+		flight->done.wait(guard, [&]() { return flight->finished; });
+		if (flight->error) {
+			// The read of another query may have failed for reasons of its own (e.g. it was interrupted), retry
+			guard.unlock();
+			read();
+			return false;
+		}
+		memcpy(buffer_out, flight->data.get(), buffer_out_len);
+		AzureMetrics::Get().deduplicated_read_count++;
+		return true;
+	}
+
+	std::exception_ptr error;
+	try {
+		read();
+	} catch (...) {
+		error = std::current_exception();
+	}
+	bool has_followers;
+	{
+		// No follower can join once the flight is removed, the ones that joined before get the result
+		lock_guard<mutex> guard(lock);
+		flights.erase(key);
+		has_followers = flight->follower_count > 0;
+	}
+	{
+		lock_guard<mutex> guard(flight->lock);
+		if (has_followers && !error) {
+			flight->data = make_unsafe_uniq_array<char>(buffer_out_len);
+			memcpy(flight->data.get(), buffer_out, buffer_out_len);
+		}
+		flight->error = error;
+		flight->finished = true;
+	}
+	flight->done.notify_all();
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	return false;
+}
+
+} // namespace duckdb
@@ -1,4 +1,6 @@
 #include "azure_storage_account_client.hpp"
+#include "azure_mock_transport.hpp"
+#include "azure_connection_limiter.hpp"
 
 #include "duckdb/catalog/catalog_transaction.hpp"
 #include "duckdb/common/enums/statement_type.hpp"
@@ -76,56 +78,114 @@ static std::string AccountUrl(const AzureParsedUrl &azure_parsed_url) {
 	return AccountUrl(azure_parsed_url.storage_account_name, azure_parsed_url.endpoint);
 }
 
+static Azure::Core::Credentials::TokenCredentialOptions
+ToTokenCredentialOptions(const Azure::Core::Http::Policies::TransportOptions &transport_options) {
+	Azure::Core::Credentials::TokenCredentialOptions options;
+	options.Transport = transport_options;
+	return options;
+}
+
+static shared_ptr<AzureHTTPState> GetHttpState(optional_ptr<FileOpener> opener) {
+	Value value;
+	bool enable_http_stats = false;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_http_stats", value)) {
+		enable_http_stats = value.GetValue<bool>();
+	}
+
+	shared_ptr<AzureHTTPState> http_state;
+	if (enable_http_stats) {
+		http_state = AzureHTTPState::TryGetState(opener);
+	}
+
+	return http_state;
+}
+
 template <typename T>
 static T ToClientOptions(const Azure::Core::Http::Policies::TransportOptions &transport_options,
-                         shared_ptr<AzureHTTPState> http_state) {
+                         optional_ptr<FileOpener> opener) {
 	static_assert(std::is_base_of<Azure::Core::_internal::ClientOptions, T>::value,
 	              "type parameter must be an Azure ClientOptions");
 	T options;
 	options.Transport = transport_options;
+
+	Value value;
+	AzureRateLimits rate_limits;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_max_requests_per_second", value) && !value.IsNull()) {
+		rate_limits.requests_per_second = value.GetValue<uint64_t>();
+	}
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_max_bytes_per_second", value) && !value.IsNull()) {
+		rate_limits.bytes_per_second = value.GetValue<uint64_t>();
+	}
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_rate_limit_adaptive", value) && !value.IsNull()) {
+		rate_limits.adaptive = value.GetValue<bool>();
+	}
+	if (rate_limits.requests_per_second > 0 || rate_limits.bytes_per_second > 0) {
+		// First of the per-retry policies, so the time spent waiting is not seen as request latency
+		options.PerRetryPolicies.emplace_back(new HttpRateLimitPolicy(rate_limits));
+	}
+
+	auto http_state = GetHttpState(opener);
 	if (http_state != nullptr) {
 		// Because we mainly want to have stats on what has been needed and not on
 		// what has been used on the network, we register the policy on `PerOperationPolicies`
 		// part and not the `PerRetryPolicies`. Network issues will result in retry that can
 		// increase the input/output but will not be displayed in the EXPLAIN summary.
-		options.PerOperationPolicies.emplace_back(new HttpStatePolicy(std::move(http_state)));
+		options.PerOperationPolicies.emplace_back(new HttpStatePolicy(http_state));
+		// Retries, throttling and backoff are accounted for separately by a per-retry companion
+		options.PerRetryPolicies.emplace_back(new HttpRetryStatePolicy(std::move(http_state)));
+	}
+	// Process wide metrics are always collected
+	options.PerRetryPolicies.emplace_back(new HttpMetricsPolicy());
+	auto client_context = FileOpener::TryGetClientContext(opener);
+	auto query_id = client_context ? client_context->transaction.GetActiveQuery() : MAXIMUM_QUERY_ID;
+	auto http_log = AzureHTTPLog::TryGetLog(opener);
+	if (http_log != nullptr) {
+		options.PerRetryPolicies.emplace_back(new HttpLogPolicy(std::move(http_log), query_id));
+	}
+	auto trace_exporter = AzureTraceExporter::TryGetExporter(opener);
+	if (trace_exporter != nullptr) {
+		options.PerOperationPolicies.emplace_back(new HttpTracePolicy(std::move(trace_exporter), query_id));
+	}
+	// Before the connection limit and timeout policies, so that they also apply to the duplicate requests
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_read_hedging", value) && value.GetValue<bool>()) {
+		options.PerRetryPolicies.emplace_back(new HttpHedgingPolicy());
+	}
+	Value max_connections;
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_http_max_connections_per_host", max_connections) &&
+	    max_connections.GetValue<uint64_t>() > 0) {
+		auto limiter = AzureConnectionLimiter::TryGet(opener, max_connections.GetValue<uint64_t>());
+		if (limiter) {
+			options.PerRetryPolicies.emplace_back(new HttpConnectionLimitPolicy(std::move(limiter)));
+		}
+	}
+
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_retry_max_retries", value) && !value.IsNull()) {
+		options.Retry.MaxRetries = value.GetValue<int32_t>();
+	}
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_retry_delay_ms", value) && !value.IsNull()) {
+		options.Retry.RetryDelay = std::chrono::milliseconds(value.GetValue<uint64_t>());
+	}
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_retry_max_delay_ms", value) && !value.IsNull()) {
+		options.Retry.MaxRetryDelay = std::chrono::milliseconds(value.GetValue<uint64_t>());
+	}
+	if (FileOpener::TryGetCurrentSetting(opener, "azure_request_timeout_ms", value) && !value.IsNull() &&
+	    value.GetValue<uint64_t>() > 0) {
+		options.PerRetryPolicies.emplace_back(
+		    new HttpTimeoutPolicy(std::chrono::milliseconds(value.GetValue<uint64_t>())));
 	}
 	return options;
 }
 
 static Azure::Storage::Blobs::BlobClientOptions
 ToBlobClientOptions(const Azure::Core::Http::Policies::TransportOptions &transport_options,
-                    shared_ptr<AzureHTTPState> http_state) {
-	return ToClientOptions<Azure::Storage::Blobs::BlobClientOptions>(transport_options, std::move(http_state));
+                    optional_ptr<FileOpener> opener) {
+	return ToClientOptions<Azure::Storage::Blobs::BlobClientOptions>(transport_options, opener);
 }
 
 static Azure::Storage::Files::DataLake::DataLakeClientOptions
 ToDfsClientOptions(const Azure::Core::Http::Policies::TransportOptions &transport_options,
-                   shared_ptr<AzureHTTPState> http_state) {
-	return ToClientOptions<Azure::Storage::Files::DataLake::DataLakeClientOptions>(transport_options,
-	                                                                               std::move(http_state));
-}
-
-static Azure::Core::Credentials::TokenCredentialOptions
-ToTokenCredentialOptions(const Azure::Core::Http::Policies::TransportOptions &transport_options) {
-	Azure::Core::Credentials::TokenCredentialOptions options;
-	options.Transport = transport_options;
-	return options;
-}
-
-static shared_ptr<AzureHTTPState> GetHttpState(optional_ptr<FileOpener> opener) {
-	Value value;
-	bool enable_http_stats = false;
-	if (FileOpener::TryGetCurrentSetting(opener, "azure_http_stats", value)) {
-		enable_http_stats = value.GetValue<bool>();
-	}
-
-	shared_ptr<AzureHTTPState> http_state;
-	if (enable_http_stats) {
-		http_state = AzureHTTPState::TryGetState(opener);
-	}
-
-	return http_state;
+                   optional_ptr<FileOpener> opener) {
+	return ToClientOptions<Azure::Storage::Files::DataLake::DataLakeClientOptions>(transport_options, opener);
 }
 
 static std::shared_ptr<Azure::Core::Credentials::TokenCredential>
@@ -276,7 +336,8 @@ CreateCurlTransport(const std::string &proxy, const std::string &proxy_username,
 	return std::make_shared<Azure::Core::Http::CurlTransport>(curl_transport_options);
 }
 
-static Azure::Core::Http::Policies::TransportOptions GetTransportOptions(const std::string &transport_option_type,
+static Azure::Core::Http::Policies::TransportOptions GetTransportOptions(optional_ptr<FileOpener> opener,
+                                                                         const std::string &transport_option_type,
                                                                          const std::string &proxy,
                                                                          const std::string &proxy_username,
                                                                          const std::string &proxy_password) {
@@ -295,6 +356,19 @@ static Azure::Core::Http::Policies::TransportOptions GetTransportOptions(const s
 		}
 	} else if (transport_option_type == "curl") {
 		transport_options.Transport = CreateCurlTransport(proxy, proxy_username, proxy_password);
+	} else if (transport_option_type == "http2") {
+		// The SDK curl transport writes HTTP/1.1 requests itself on the sockets of its connection pool, curl's HTTP/2
+		// support is never involved
+		throw NotImplementedException(
+		    "transport_option_type 'http2' is not supported: the Azure SDK transports only speak HTTP/1.1. Use "
+		    "azure_http_max_connections_per_host to bound the number of connections opened by parallel reads instead");
+	} else if (transport_option_type == "mock") {
+		auto client_context = FileOpener::TryGetClientContext(opener);
+		if (!client_context) {
+			throw InvalidInputException("transport_option_type 'mock' can only be used from a connection");
+		}
+		transport_options.Transport = std::make_shared<AzureMockTransport>(
+		    FileSystem::GetFileSystem(*client_context), AzureMockTransport::ParseOptions(opener));
 	} else {
 		throw InvalidInputException("transport_option_type cannot take value '%s'", transport_option_type);
 	}
@@ -330,7 +404,7 @@ static Azure::Core::Http::Policies::TransportOptions GetTransportOptions(optiona
 		http_proxy_password = http_proxy_password_val.ToString();
 	}
 
-	return GetTransportOptions(transport_option_type, http_proxy, http_proxy_username, http_proxy_password);
+	return GetTransportOptions(opener, transport_option_type, http_proxy, http_proxy_username, http_proxy_password);
 }
 
 static Azure::Storage::Blobs::BlobServiceClient
@@ -348,14 +422,14 @@ GetBlobStorageAccountClientFromConfigProvider(optional_ptr<FileOpener> opener, c
 			                            azure_parsed_url.storage_account_name);
 		}
 
-		auto blob_options = ToBlobClientOptions(transport_options, GetHttpState(opener));
+		auto blob_options = ToBlobClientOptions(transport_options, opener);
 		return Azure::Storage::Blobs::BlobServiceClient::CreateFromConnectionString(connection_string, blob_options);
 	}
 
 	// Default provider (config) with no connection string => public storage account
 	auto account_url =
 	    azure_parsed_url.is_fully_qualified ? AccountUrl(azure_parsed_url) : AccountUrl(secret, DEFAULT_BLOB_ENDPOINT);
-	auto blob_options = ToBlobClientOptions(transport_options, GetHttpState(opener));
+	auto blob_options = ToBlobClientOptions(transport_options, opener);
 	return Azure::Storage::Blobs::BlobServiceClient(account_url, blob_options);
 }
 
@@ -374,7 +448,7 @@ GetDfsStorageAccountClientFromConfigProvider(optional_ptr<FileOpener> opener, co
 			                            azure_parsed_url.storage_account_name);
 		}
 
-		auto dfs_options = ToDfsClientOptions(transport_options, GetHttpState(opener));
+		auto dfs_options = ToDfsClientOptions(transport_options, opener);
 		return Azure::Storage::Files::DataLake::DataLakeServiceClient::CreateFromConnectionString(connection_string,
 		                                                                                          dfs_options);
 	}
@@ -382,7 +456,7 @@ GetDfsStorageAccountClientFromConfigProvider(optional_ptr<FileOpener> opener, co
 	// Default provider (config) with no connection string => public storage account
 	auto account_url =
 	    azure_parsed_url.is_fully_qualified ? AccountUrl(azure_parsed_url) : AccountUrl(secret, DEFAULT_DFS_ENDPOINT);
-	auto dfs_options = ToDfsClientOptions(transport_options, GetHttpState(opener));
+	auto dfs_options = ToDfsClientOptions(transport_options, opener);
 	return Azure::Storage::Files::DataLake::DataLakeServiceClient(account_url, dfs_options);
 }
 
@@ -396,7 +470,7 @@ GetBlobStorageAccountClientFromCredentialChainProvider(optional_ptr<FileOpener>
 	// Connect to storage account
 	auto account_url =
 	    azure_parsed_url.is_fully_qualified ? AccountUrl(azure_parsed_url) : AccountUrl(secret, DEFAULT_BLOB_ENDPOINT);
-	auto blob_options = ToBlobClientOptions(transport_options, GetHttpState(opener));
+	auto blob_options = ToBlobClientOptions(transport_options, opener);
 	return Azure::Storage::Blobs::BlobServiceClient(account_url, std::move(credential), blob_options);
 }
 
@@ -410,7 +484,7 @@ GetDfsStorageAccountClientFromCredentialChainProvider(optional_ptr<FileOpener> o
 	// Connect to storage account
 	auto account_url =
 	    azure_parsed_url.is_fully_qualified ? AccountUrl(azure_parsed_url) : AccountUrl(secret, DEFAULT_DFS_ENDPOINT);
-	auto dfs_options = ToDfsClientOptions(transport_options, GetHttpState(opener));
+	auto dfs_options = ToDfsClientOptions(transport_options, opener);
 	return Azure::Storage::Files::DataLake::DataLakeServiceClient(account_url, std::move(credential), dfs_options);
 }
 
@@ -423,7 +497,7 @@ GetBlobStorageAccountClientFromServicePrincipalProvider(optional_ptr<FileOpener>
 	auto account_url =
 	    azure_parsed_url.is_fully_qualified ? AccountUrl(azure_parsed_url) : AccountUrl(secret, DEFAULT_BLOB_ENDPOINT);
 	;
-	auto blob_options = ToBlobClientOptions(transport_options, GetHttpState(opener));
+	auto blob_options = ToBlobClientOptions(transport_options, opener);
 	return Azure::Storage::Blobs::BlobServiceClient(account_url, token_credential, blob_options);
 }
 
@@ -436,7 +510,7 @@ GetDfsStorageAccountClientFromServicePrincipalProvider(optional_ptr<FileOpener>
 	auto account_url =
 	    azure_parsed_url.is_fully_qualified ? AccountUrl(azure_parsed_url) : AccountUrl(secret, DEFAULT_DFS_ENDPOINT);
 	;
-	auto dfs_options = ToDfsClientOptions(transport_options, GetHttpState(opener));
+	auto dfs_options = ToDfsClientOptions(transport_options, opener);
 	return Azure::Storage::Files::DataLake::DataLakeServiceClient(account_url, token_credential, dfs_options);
 }
 
@@ -449,7 +523,7 @@ GetBlobStorageAccountClientFromAccessTokenProvider(optional_ptr<FileOpener> open
 	auto account_url =
 	    azure_parsed_url.is_fully_qualified ? AccountUrl(azure_parsed_url) : AccountUrl(secret, DEFAULT_BLOB_ENDPOINT);
 	;
-	auto blob_options = ToBlobClientOptions(transport_options, GetHttpState(opener));
+	auto blob_options = ToBlobClientOptions(transport_options, opener);
 	return Azure::Storage::Blobs::BlobServiceClient(account_url, token_credential, blob_options);
 }
 
@@ -462,7 +536,7 @@ GetDfsStorageAccountClientFromAccessTokenProvider(optional_ptr<FileOpener> opene
 	auto account_url =
 	    azure_parsed_url.is_fully_qualified ? AccountUrl(azure_parsed_url) : AccountUrl(secret, DEFAULT_DFS_ENDPOINT);
 	;
-	auto dfs_options = ToDfsClientOptions(transport_options, GetHttpState(opener));
+	auto dfs_options = ToDfsClientOptions(transport_options, opener);
 	return Azure::Storage::Files::DataLake::DataLakeServiceClient(account_url, token_credential, dfs_options);
 }
 
@@ -510,14 +584,15 @@ static Azure::Core::Http::Policies::TransportOptions GetTransportOptions(optiona
 	auto http_proxy_user_name = TryGetCurrentSetting(opener, "azure_proxy_user_name");
 	auto http_proxy_password = TryGetCurrentSetting(opener, "azure_proxy_password");
 
-	return GetTransportOptions(azure_transport_option_type, http_proxy, http_proxy_user_name, http_proxy_password);
+	return GetTransportOptions(opener, azure_transport_option_type, http_proxy, http_proxy_user_name,
+	                           http_proxy_password);
 }
 
 static Azure::Storage::Blobs::BlobServiceClient GetBlobStorageAccountClient(optional_ptr<FileOpener> opener,
                                                                             const std::string &provided_storage_account,
                                                                             const std::string &provided_endpoint) {
 	auto transport_options = GetTransportOptions(opener);
-	auto blob_options = ToBlobClientOptions(transport_options, GetHttpState(opener));
+	auto blob_options = ToBlobClientOptions(transport_options, opener);
 
 	auto connection_string = TryGetCurrentSetting(opener, "azure_storage_connection_string");
 	if (!connection_string.empty() &&
@@ -602,7 +677,7 @@ ConnectToDfsStorageAccount(optional_ptr<FileOpener> opener, const std::string &p
 	// No secret but FQDN has been provided, connect to a public storage account
 	auto transport_options = GetTransportOptions(opener);
 	auto account_url = "https://" + azure_parsed_url.storage_account_name + '.' + azure_parsed_url.endpoint;
-	auto dfs_options = ToDfsClientOptions(transport_options, GetHttpState(opener));
+	auto dfs_options = ToDfsClientOptions(transport_options, opener);
 	return Azure::Storage::Files::DataLake::DataLakeServiceClient(account_url, dfs_options);
 }
 
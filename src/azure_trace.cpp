@@ -0,0 +1,152 @@
+#include "azure_trace.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/value.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/database.hpp"
+
+#include <chrono>
+#include <random>
+
+namespace duckdb {
+
+static std::mt19937_64 &RandomEngine() {
+	static thread_local std::mt19937_64 engine(std::random_device {}());
+	return engine;
+}
+
+static string ToHex(uint64_t value) {
+	return StringUtil::Format("%016llx", static_cast<unsigned long long>(value));
+}
+
+// Spans are linked to their query through the trace id, its random prefix (drawn once per process) avoids collisions
+// between the query ids of different processes
+static const uint64_t TRACE_ID_PREFIX = std::random_device {}() | (uint64_t(std::random_device {}()) << 32);
+
+AzureTraceExporter::AzureTraceExporter(string path_p, unique_ptr<FileHandle> handle_p)
+    : path(std::move(path_p)), handle(std::move(handle_p)) {
+}
+
+shared_ptr<AzureTraceExporter> AzureTraceExporter::TryGetExporter(optional_ptr<FileOpener> opener) {
+	Value value;
+	if (!FileOpener::TryGetCurrentSetting(opener, "azure_trace_file", value) || value.IsNull()) {
+		return nullptr;
+	}
+	auto path = value.ToString();
+	if (path.empty()) {
+		return nullptr;
+	}
+
+	auto client_context = FileOpener::TryGetClientContext(opener);
+	if (!client_context) {
+		return nullptr;
+	}
+
+	// The connections of a database tracing to the same file share its exporter
+	static mutex exporters_lock;
+	lock_guard<mutex> guard(exporters_lock);
+	auto &cache = client_context->db->GetObjectCache();
+	auto key = ObjectType() + ":" + path;
+	auto exporter = cache.Get<AzureTraceExporter>(key);
+	if (!exporter) {
+		auto &fs = FileSystem::GetFileSystem(*client_context);
+		auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE |
+		                                    FileFlags::FILE_FLAGS_APPEND);
+		exporter = make_shared_ptr<AzureTraceExporter>(path, std::move(handle));
+		cache.Put(key, exporter);
+	}
+
+	string write_error;
+	{
+		lock_guard<mutex> exporter_guard(exporter->lock);
+		std::swap(write_error, exporter->write_error);
+	}
+	if (!write_error.empty()) {
+		throw IOException("Could not write spans to the Azure trace file '%s': %s", path, write_error);
+	}
+	return exporter;
+}
+
+string AzureTraceExporter::TraceId(transaction_t query_id) {
+	if (query_id == MAXIMUM_QUERY_ID) {
+		return ToHex(RandomEngine()()) + ToHex(RandomEngine()());
+	}
+	return ToHex(TRACE_ID_PREFIX) + ToHex(query_id);
+}
+
+string AzureTraceExporter::NewSpanId() {
+	return ToHex(RandomEngine()());
+}
+
+int64_t AzureTraceExporter::NowNanoseconds() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+	    .count();
+}
+
+static string JSONString(const string &value) {
+	string result = "\"";
+	for (auto c : value) {
+		switch (c) {
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		case '\n':
+			result += "\\n";
+			break;
+		case '\r':
+			result += "\\r";
+			break;
+		case '\t':
+			result += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				result += StringUtil::Format("\\u%04x", int(c));
+			} else {
+				result += c;
+			}
+		}
+	}
+	return result + "\"";
+}
+
+static string SpanToJSON(const AzureSpan &span) {
+	string attributes;
+	for (auto &attribute : span.string_attributes) {
+		attributes += attributes.empty() ? "" : ",";
+		attributes += "{\"key\":" + JSONString(attribute.first) +
+		              ",\"value\":{\"stringValue\":" + JSONString(attribute.second) + "}}";
+	}
+	for (auto &attribute : span.int_attributes) {
+		attributes += attributes.empty() ? "" : ",";
+		// OTLP/JSON encodes 64 bits integers as strings
+		attributes += "{\"key\":" + JSONString(attribute.first) + ",\"value\":{\"intValue\":\"" +
+		              to_string(attribute.second) + "\"}}";
+	}
+	string status = span.error.empty() ? "{\"code\":1}" : "{\"code\":2,\"message\":" + JSONString(span.error) + "}";
+
+	// Kind 3 is SPAN_KIND_CLIENT
+	return "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":{\"stringValue\":"
+	       "\"duckdb\"}}]},\"scopeSpans\":[{\"scope\":{\"name\":\"duckdb_azure\"},\"spans\":[{\"traceId\":\"" +
+	       span.trace_id + "\",\"spanId\":\"" + span.span_id + "\",\"name\":" + JSONString(span.name) +
+	       ",\"kind\":3,\"startTimeUnixNano\":\"" + to_string(span.start_time_ns) + "\",\"endTimeUnixNano\":\"" +
+	       to_string(span.end_time_ns) + "\",\"attributes\":[" + attributes + "],\"status\":" + status + "}]}]}]}\n";
+}
+
+void AzureTraceExporter::Export(const AzureSpan &span) {
+	auto line = SpanToJSON(span);
+	lock_guard<mutex> guard(lock);
+	try {
+		handle->Write((void *)line.data(), line.size());
+	} catch (std::exception &ex) {
+		if (write_error.empty()) {
+			write_error = ErrorData(ex).RawMessage();
+		}
+	}
+}
+
+} // namespace duckdb
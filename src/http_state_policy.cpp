@@ -1,14 +1,87 @@
 #include "http_state_policy.hpp"
+#include "azure_io_executor.hpp"
 #include <azure/core/http/http.hpp>
+#include <azure/core/http/policies/policy.hpp>
+#include <azure/core/http/transport.hpp>
+#include <azure/core/io/body_stream.hpp>
+#include "duckdb/common/helper.hpp"
 #include "duckdb/common/shared_ptr.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <exception>
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 
-const static std::string CONTENT_LENGTH = "content-length";
-
 namespace duckdb {
 
+static idx_t MicrosecondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Responses that are not buffered by the SDK (e.g. downloads) are only received once the caller consumes their body.
+// This stream wraps such bodies to call `on_done` once: when the body has been fully read, or when the stream is
+// destroyed before that (e.g. a streamed download that is abandoned on a seek).
+class ObservedBodyStream : public Azure::Core::IO::BodyStream {
+public:
+	using on_done_t = std::function<void(idx_t bytes_read, bool completed)>;
+
+	ObservedBodyStream(std::unique_ptr<Azure::Core::IO::BodyStream> inner, on_done_t on_done)
+	    : inner(std::move(inner)), on_done(std::move(on_done)), bytes_read(0), done(false) {
+	}
+	~ObservedBodyStream() override {
+		Done(false);
+	}
+
+	int64_t Length() const override {
+		return inner->Length();
+	}
+
+	void Rewind() override {
+		inner->Rewind();
+		bytes_read = 0;
+	}
+
+private:
+	size_t OnRead(uint8_t *buffer, size_t count, Azure::Core::Context const &context) override {
+		auto read = inner->Read(buffer, count, context);
+		bytes_read += read;
+		if (read == 0 || (Length() >= 0 && bytes_read >= idx_t(Length()))) {
+			Done(true);
+		}
+		return read;
+	}
+
+	void Done(bool completed) {
+		if (done) {
+			return;
+		}
+		done = true;
+		on_done(bytes_read, completed);
+	}
+
+private:
+	std::unique_ptr<Azure::Core::IO::BodyStream> inner;
+	on_done_t on_done;
+	idx_t bytes_read;
+	bool done;
+};
+
+//! Calls `on_done` once the body of the response has been received
+static void ObserveResponseBody(Azure::Core::Http::RawResponse &response, ObservedBodyStream::on_done_t on_done) {
+	auto response_stream = response.ExtractBodyStream();
+	if (response_stream == nullptr) {
+		// The body has already been received
+		on_done(response.GetBody().size(), true);
+		return;
+	}
+	response.SetBodyStream(std::unique_ptr<Azure::Core::IO::BodyStream>(
+	    new ObservedBodyStream(std::move(response_stream), std::move(on_done))));
+}
+
 HttpStatePolicy::HttpStatePolicy(shared_ptr<AzureHTTPState> http_state) : http_state(std::move(http_state)) {
 }
 
@@ -24,14 +97,19 @@ HttpStatePolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Po
 
 	const auto &method = request.GetMethod();
 
+	AzureLatencyHistogram *latency = nullptr;
 	if (HttpMethod::Head == method) {
 		http_state->head_count++;
+		latency = &http_state->head_latency;
 	} else if (HttpMethod::Get == method) {
 		http_state->get_count++;
+		latency = &http_state->get_latency;
 	} else if (HttpMethod::Put == method) {
 		http_state->put_count++;
+		latency = &http_state->put_latency;
 	} else if (HttpMethod::Post == method) {
 		http_state->post_count++;
+		latency = &http_state->post_latency;
 	}
 
 	const auto *body_stream = request.GetBodyStream();
@@ -39,22 +117,20 @@ HttpStatePolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Po
 		http_state->total_bytes_sent += body_stream->Length();
 	}
 
+	auto start = std::chrono::steady_clock::now();
 	auto result = next_policy.Send(request, context);
 	if (result != nullptr) {
-		const auto &response_body = result->GetBody();
-		if (response_body.size() != 0) {
-			http_state->total_bytes_received += response_body.size();
-		} else {
-			// the result of `GetBody().size()` doesn't seen to be accurate (zero)
-			// the internal response as a BodyStream but the only wait to get it is by
-			// taking the ownership on it. So to compute the size let use teh content-length
-			// header it should be ok
-			const auto &headers = result->GetHeaders();
-			auto it = headers.find(CONTENT_LENGTH);
-			if (it != headers.end()) {
-				http_state->total_bytes_received += std::stoll(it->second);
+		http_state->ttfb_latency.Add(MicrosecondsSince(start));
+
+		// Count the bytes of the body that are actually read, the content-length of a response is not what has been
+		// received (e.g. HEAD responses or downloads abandoned on a seek)
+		auto state = http_state;
+		ObserveResponseBody(*result, [state, latency, start](idx_t bytes_read, bool completed) {
+			state->total_bytes_received += bytes_read;
+			if (latency && completed) {
+				latency->Add(MicrosecondsSince(start));
 			}
-		}
+		});
 	}
 
 	return result;
@@ -64,4 +140,513 @@ std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpStatePolicy::Clone(
 	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpStatePolicy(http_state));
 }
 
+// The SDK retry policy sleeps on the thread performing the request, the end of the previous attempt made by this
+// thread is used to know how long we waited before retrying
+static thread_local std::chrono::steady_clock::time_point last_attempt_end;
+
+HttpRetryStatePolicy::HttpRetryStatePolicy(shared_ptr<AzureHTTPState> http_state) : http_state(std::move(http_state)) {
+}
+
+std::unique_ptr<Azure::Core::Http::RawResponse>
+HttpRetryStatePolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+                           Azure::Core::Context const &context) const {
+	auto start = std::chrono::steady_clock::now();
+	http_state->attempt_count++;
+	if (Azure::Core::Http::Policies::_internal::RetryPolicy::GetRetryCount(context) > 0) {
+		http_state->retry_count++;
+		http_state->backoff_time_us +=
+		    std::chrono::duration_cast<std::chrono::microseconds>(start - last_attempt_end).count();
+	}
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> result;
+	try {
+		result = next_policy.Send(request, context);
+	} catch (Azure::Core::Http::TransportException &) {
+		http_state->transport_error_count++;
+		last_attempt_end = std::chrono::steady_clock::now();
+		http_state->attempt_time_us += MicrosecondsSince(start);
+		throw;
+	}
+	last_attempt_end = std::chrono::steady_clock::now();
+	http_state->attempt_time_us += MicrosecondsSince(start);
+
+	if (result != nullptr) {
+		auto state = http_state;
+		auto headers_received = last_attempt_end;
+		ObserveResponseBody(*result, [state, headers_received](idx_t, bool) {
+			// For streamed downloads this includes the time the reader spends between two reads of the body
+			state->body_time_us += MicrosecondsSince(headers_received);
+		});
+
+		auto status_code = static_cast<idx_t>(result->GetStatusCode());
+		if (status_code < 300) {
+			http_state->status_2xx_count++;
+		} else if (status_code < 400) {
+			http_state->status_3xx_count++;
+		} else if (status_code < 500) {
+			http_state->status_4xx_count++;
+		} else {
+			http_state->status_5xx_count++;
+		}
+		if (status_code == 429 || status_code == 503) {
+			http_state->throttled_count++;
+		}
+	}
+	return result;
+}
+
+std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpRetryStatePolicy::Clone() const {
+	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpRetryStatePolicy(http_state));
+}
+
+std::unique_ptr<Azure::Core::Http::RawResponse>
+HttpMetricsPolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+                        Azure::Core::Context const &context) const {
+	using HttpMethod = ::Azure::Core::Http::HttpMethod;
+
+	auto &metrics = AzureMetrics::Get();
+	const auto &method = request.GetMethod();
+	auto method_index = AzureMetrics::Method::OTHER;
+	if (HttpMethod::Head == method) {
+		method_index = AzureMetrics::Method::HEAD;
+	} else if (HttpMethod::Get == method) {
+		method_index = AzureMetrics::Method::GET;
+	} else if (HttpMethod::Put == method) {
+		method_index = AzureMetrics::Method::PUT;
+	} else if (HttpMethod::Post == method) {
+		method_index = AzureMetrics::Method::POST;
+	}
+	metrics.request_count[static_cast<idx_t>(method_index)]++;
+	if (Azure::Core::Http::Policies::_internal::RetryPolicy::GetRetryCount(context) > 0) {
+		metrics.retry_count++;
+	}
+	const auto *body_stream = request.GetBodyStream();
+	if (body_stream != nullptr && body_stream->Length() > 0) {
+		metrics.bytes_sent += body_stream->Length();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	metrics.requests_in_flight++;
+	std::unique_ptr<Azure::Core::Http::RawResponse> result;
+	try {
+		result = next_policy.Send(request, context);
+	} catch (Azure::Core::Http::TransportException &) {
+		metrics.requests_in_flight--;
+		metrics.transport_error_count++;
+		throw;
+	} catch (...) {
+		metrics.requests_in_flight--;
+		throw;
+	}
+	if (result == nullptr) {
+		metrics.requests_in_flight--;
+		return result;
+	}
+
+	auto status_code = static_cast<idx_t>(result->GetStatusCode());
+	if (status_code < 300) {
+		metrics.status_2xx_count++;
+	} else if (status_code < 400) {
+		metrics.status_3xx_count++;
+	} else if (status_code < 500) {
+		metrics.status_4xx_count++;
+	} else {
+		metrics.status_5xx_count++;
+	}
+	if (status_code == 429 || status_code == 503) {
+		metrics.throttled_count++;
+	}
+	// The request is in flight until its body has been received
+	ObserveResponseBody(*result, [start](idx_t bytes_read, bool completed) {
+		auto &metrics = AzureMetrics::Get();
+		metrics.requests_in_flight--;
+		metrics.bytes_received += bytes_read;
+		if (completed) {
+			metrics.request_latency.Add(MicrosecondsSince(start));
+		}
+	});
+	return result;
+}
+
+std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpMetricsPolicy::Clone() const {
+	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpMetricsPolicy());
+}
+
+HttpLogPolicy::HttpLogPolicy(shared_ptr<AzureHTTPLog> http_log, transaction_t query_id)
+    : http_log(std::move(http_log)), query_id(query_id) {
+}
+
+std::unique_ptr<Azure::Core::Http::RawResponse>
+HttpLogPolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+                    Azure::Core::Context const &context) const {
+	AzureHTTPLogEntry entry;
+	entry.query_id = query_id;
+	entry.method = request.GetMethod().ToString();
+	entry.path = request.GetUrl().GetPath();
+	const auto headers = request.GetHeaders();
+	auto range = headers.find("x-ms-range");
+	if (range == headers.end()) {
+		range = headers.find("range");
+	}
+	if (range != headers.end()) {
+		entry.range = range->second;
+	}
+	const auto *body_stream = request.GetBodyStream();
+	if (body_stream != nullptr && body_stream->Length() > 0) {
+		entry.bytes_sent = body_stream->Length();
+	}
+	entry.thread_id = std::hash<std::thread::id>()(std::this_thread::get_id());
+	entry.retry = MaxValue<int32_t>(0, Azure::Core::Http::Policies::_internal::RetryPolicy::GetRetryCount(context));
+	entry.start_time = Timestamp::GetCurrentTimestamp();
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> result;
+	try {
+		result = next_policy.Send(request, context);
+	} catch (std::exception &ex) {
+		entry.end_time = Timestamp::GetCurrentTimestamp();
+		entry.error = ex.what();
+		http_log->Add(std::move(entry));
+		throw;
+	}
+
+	if (result != nullptr) {
+		entry.status = static_cast<int32_t>(result->GetStatusCode());
+		auto log = http_log;
+		ObserveResponseBody(*result, [log, entry](idx_t bytes_read, bool completed) mutable {
+			entry.bytes_received = bytes_read;
+			entry.end_time = Timestamp::GetCurrentTimestamp();
+			log->Add(std::move(entry));
+		});
+	}
+	return result;
+}
+
+std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpLogPolicy::Clone() const {
+	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpLogPolicy(http_log, query_id));
+}
+
+// Name of the storage operation performed by a request, from its method and query parameters
+static string OperationName(const Azure::Core::Http::Request &request, bool has_range) {
+	using HttpMethod = ::Azure::Core::Http::HttpMethod;
+
+	const auto &method = request.GetMethod();
+	const auto &parameters = request.GetUrl().GetQueryParameters();
+	auto parameter = [&](const string &name) {
+		auto entry = parameters.find(name);
+		return entry == parameters.end() ? string() : entry->second;
+	};
+
+	if (HttpMethod::Head == method) {
+		return "open";
+	}
+	if (HttpMethod::Get == method) {
+		// Blob listings use `comp=list`, DFS listings `resource=filesystem`
+		if (parameter("comp") == "list" || parameter("resource") == "filesystem") {
+			return "list page";
+		}
+		return has_range ? "read range" : "read";
+	}
+	if (HttpMethod::Put == method) {
+		if (parameter("comp") == "block" || parameter("action") == "append") {
+			return "upload part";
+		}
+		if (parameter("comp") == "blocklist" || parameter("action") == "flush") {
+			return "commit upload";
+		}
+		return "upload";
+	}
+	return method.ToString();
+}
+
+HttpTracePolicy::HttpTracePolicy(shared_ptr<AzureTraceExporter> exporter, transaction_t query_id)
+    : exporter(std::move(exporter)), query_id(query_id) {
+}
+
+std::unique_ptr<Azure::Core::Http::RawResponse>
+HttpTracePolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+                      Azure::Core::Context const &context) const {
+	AzureSpan span;
+	span.trace_id = AzureTraceExporter::TraceId(query_id);
+	span.span_id = AzureTraceExporter::NewSpanId();
+
+	const auto &url = request.GetUrl();
+	auto host = url.GetHost();
+	auto path = url.GetPath();
+	span.string_attributes.emplace_back("azure.account", host.substr(0, host.find('.')));
+	span.string_attributes.emplace_back("azure.container", path.substr(0, path.find('/')));
+	span.string_attributes.emplace_back("azure.path", path);
+	span.string_attributes.emplace_back("http.request.method", request.GetMethod().ToString());
+	const auto headers = request.GetHeaders();
+	auto range = headers.find("x-ms-range");
+	if (range == headers.end()) {
+		range = headers.find("range");
+	}
+	if (range != headers.end()) {
+		span.string_attributes.emplace_back("azure.range", range->second);
+	}
+	span.name = OperationName(request, range != headers.end());
+	if (query_id != MAXIMUM_QUERY_ID) {
+		span.int_attributes.emplace_back("duckdb.query_id", query_id);
+	}
+
+	span.start_time_ns = AzureTraceExporter::NowNanoseconds();
+	std::unique_ptr<Azure::Core::Http::RawResponse> result;
+	try {
+		result = next_policy.Send(request, context);
+	} catch (std::exception &ex) {
+		span.end_time_ns = AzureTraceExporter::NowNanoseconds();
+		span.error = ex.what();
+		exporter->Export(span);
+		throw;
+	}
+
+	if (result != nullptr) {
+		auto status_code = static_cast<int64_t>(result->GetStatusCode());
+		span.int_attributes.emplace_back("http.response.status_code", status_code);
+		if (status_code >= 400) {
+			span.error = result->GetReasonPhrase();
+		}
+		auto span_exporter = exporter;
+		ObserveResponseBody(*result, [span_exporter, span](idx_t bytes_read, bool completed) mutable {
+			span.end_time_ns = AzureTraceExporter::NowNanoseconds();
+			span.int_attributes.emplace_back("http.response.body.size", bytes_read);
+			if (!completed) {
+				span.string_attributes.emplace_back("azure.body", "abandoned");
+			}
+			span_exporter->Export(span);
+		});
+	}
+	return result;
+}
+
+std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpTracePolicy::Clone() const {
+	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpTracePolicy(exporter, query_id));
+}
+
+HttpConnectionLimitPolicy::HttpConnectionLimitPolicy(shared_ptr<AzureConnectionLimiter> limiter)
+    : limiter(std::move(limiter)) {
+}
+
+std::unique_ptr<Azure::Core::Http::RawResponse>
+HttpConnectionLimitPolicy::Send(Azure::Core::Http::Request &request,
+                                Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+                                Azure::Core::Context const &context) const {
+	auto host = request.GetUrl().GetHost();
+	limiter->Acquire(host, context);
+	std::unique_ptr<Azure::Core::Http::RawResponse> result;
+	try {
+		result = next_policy.Send(request, context);
+	} catch (...) {
+		limiter->Release(host);
+		throw;
+	}
+	if (result == nullptr || AzureConnectionLimiter::IsOpenBody(context)) {
+		limiter->Release(host);
+		return result;
+	}
+	// The connection goes back to the pool once the body has been read, or dropped with the body
+	auto connection_limiter = limiter;
+	ObserveResponseBody(*result, [connection_limiter, host](idx_t bytes_read, bool completed) {
+		connection_limiter->Release(host);
+	});
+	return result;
+}
+
+std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpConnectionLimitPolicy::Clone() const {
+	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpConnectionLimitPolicy(limiter));
+}
+
+HttpTimeoutPolicy::HttpTimeoutPolicy(std::chrono::milliseconds timeout) : timeout(timeout) {
+}
+
+std::unique_ptr<Azure::Core::Http::RawResponse>
+HttpTimeoutPolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+                        Azure::Core::Context const &context) const {
+	auto attempt_context = context.WithDeadline(std::chrono::system_clock::now() + timeout);
+	try {
+		return next_policy.Send(request, attempt_context);
+	} catch (Azure::Core::OperationCancelledException &) {
+		if (context.IsCancelled()) {
+			throw;
+		}
+		// Unlike a cancellation, a transport error is retried
+		AzureMetrics::Get().timeout_count++;
+		throw Azure::Core::Http::TransportException("No response received after " + to_string(timeout.count()) +
+		                                            " ms (azure_request_timeout_ms)");
+	}
+}
+
+std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpTimeoutPolicy::Clone() const {
+	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpTimeoutPolicy(timeout));
+}
+
+HttpHedgingPolicy::HttpHedgingPolicy() {
+}
+
+std::unique_ptr<Azure::Core::Http::RawResponse>
+HttpHedgingPolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+                        Azure::Core::Context const &context) const {
+	const auto headers = request.GetHeaders();
+	bool has_range = headers.find("x-ms-range") != headers.end() || headers.find("range") != headers.end();
+	if (!has_range || request.GetMethod() != Azure::Core::Http::HttpMethod::Get || request.ShouldBufferResponse()) {
+		return next_policy.Send(request, context);
+	}
+
+	auto &metrics = AzureMetrics::Get();
+	auto &executor = AzureIOExecutor::Get();
+	auto start = std::chrono::steady_clock::now();
+	if (metrics.range_response_latency.Count() < MINIMUM_SAMPLES || executor.ThreadCount() == 0) {
+		auto response = next_policy.Send(request, context);
+		metrics.range_response_latency.Add(MicrosecondsSince(start));
+		return response;
+	}
+	auto hedge_delay = std::chrono::microseconds(metrics.range_response_latency.Percentile(95));
+
+	// Each request gets its own context so the one that loses can be cancelled
+	auto far_deadline = std::chrono::system_clock::now() + std::chrono::hours(24);
+	auto primary_context = context.WithDeadline(far_deadline);
+	auto hedge_context = context.WithDeadline(far_deadline);
+	// Copied before the policies after this one see the original request
+	auto hedge_request = request;
+	mutex lock;
+	bool primary_done = false;
+	std::unique_ptr<Azure::Core::Http::RawResponse> hedge_response;
+
+	// The hedge only starts if the original request has not been answered after the p95, through the same policies.
+	// It uses the state of this call by reference: it is cancelled or waited for before returning
+	auto hedge = executor.SubmitAfter(hedge_delay, [&]() {
+		{
+			lock_guard<mutex> guard(lock);
+			if (primary_done) {
+				return;
+			}
+		}
+		metrics.hedged_request_count++;
+		std::unique_ptr<Azure::Core::Http::RawResponse> response;
+		try {
+			response = next_policy.Send(hedge_request, hedge_context);
+		} catch (...) {
+			// The original request decides the outcome
+			return;
+		}
+		lock_guard<mutex> guard(lock);
+		if (!primary_done) {
+			hedge_response = std::move(response);
+			primary_context.Cancel();
+		}
+	});
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> response;
+	std::exception_ptr error;
+	try {
+		response = next_policy.Send(request, primary_context);
+	} catch (...) {
+		error = std::current_exception();
+	}
+	{
+		lock_guard<mutex> guard(lock);
+		primary_done = true;
+	}
+	if (!hedge->Cancel()) {
+		if (response) {
+			hedge_context.Cancel();
+		}
+		hedge->Wait();
+	}
+	if (!response && hedge_response) {
+		metrics.hedge_win_count++;
+		response = std::move(hedge_response);
+	}
+	if (!response) {
+		std::rethrow_exception(error);
+	}
+	metrics.range_response_latency.Add(MicrosecondsSince(start));
+	return response;
+}
+
+std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpHedgingPolicy::Clone() const {
+	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpHedgingPolicy());
+}
+
+HttpRateLimitPolicy::HttpRateLimitPolicy(AzureRateLimits limits) : limits(limits) {
+}
+
+//! Parses a bound of a byte range, false unless it is a decimal number that fits in an idx_t
+static bool ParseRangeBound(const string &text, idx_t &result) {
+	// 19 digits always fit in 64 bits
+	if (text.empty() || text.size() > 19) {
+		return false;
+	}
+	result = 0;
+	for (auto c : text) {
+		if (!std::isdigit(static_cast<unsigned char>(c))) {
+			return false;
+		}
+		result = result * 10 + idx_t(c - '0');
+	}
+	return true;
+}
+
+//! Bytes a request will transfer when known before it is sent: its body, or the length of the range it reads. 0 when
+//! unknown, the request is then only limited by the request rate
+static idx_t ExpectedBytes(const Azure::Core::Http::Request &request) {
+	const auto *body_stream = request.GetBodyStream();
+	if (body_stream != nullptr && body_stream->Length() > 0) {
+		return body_stream->Length();
+	}
+	const auto headers = request.GetHeaders();
+	auto range = headers.find("x-ms-range");
+	if (range == headers.end()) {
+		range = headers.find("range");
+	}
+	if (range == headers.end()) {
+		return 0;
+	}
+	// "bytes=<start>-<end>", the end is omitted for open ended ranges. Anything else (e.g. several ranges) is unknown
+	const string prefix = "bytes=";
+	if (range->second.compare(0, prefix.size(), prefix) != 0) {
+		return 0;
+	}
+	auto bounds = range->second.substr(prefix.size());
+	auto dash = bounds.find('-');
+	idx_t start;
+	idx_t end;
+	if (dash == string::npos || !ParseRangeBound(bounds.substr(0, dash), start) ||
+	    !ParseRangeBound(bounds.substr(dash + 1), end) || end < start) {
+		return 0;
+	}
+	return end - start + 1;
+}
+
+//! Storage account a request is sent to: the first label of `<account>.blob.<suffix>` or `<account>.dfs.<suffix>`, so
+//! that both endpoints of an account share its budget. Emulators (e.g. Azurite) are addressed by IP or `localhost` and
+//! take the account as the first segment of the path instead
+static string StorageAccountName(const Azure::Core::Url &url) {
+	const auto &host = url.GetHost();
+	auto label = host.substr(0, host.find('.'));
+	bool is_emulator = label == "localhost" || (!label.empty() && std::all_of(label.begin(), label.end(), ::isdigit));
+	if (!is_emulator) {
+		return label;
+	}
+	const auto &path = url.GetPath();
+	return host + "/" + path.substr(0, path.find('/'));
+}
+
+std::unique_ptr<Azure::Core::Http::RawResponse>
+HttpRateLimitPolicy::Send(Azure::Core::Http::Request &request, Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+                          Azure::Core::Context const &context) const {
+	auto &limiter = AzureRateLimiter::Get(StorageAccountName(request.GetUrl()), limits);
+	AzureMetrics::Get().rate_limit_wait_us += limiter.Acquire(ExpectedBytes(request));
+
+	auto result = next_policy.Send(request, context);
+	if (result != nullptr) {
+		limiter.OnResponse(static_cast<int32_t>(result->GetStatusCode()));
+	}
+	return result;
+}
+
+std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> HttpRateLimitPolicy::Clone() const {
+	return std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy>(new HttpRateLimitPolicy(limits));
+}
+
 } // namespace duckdb
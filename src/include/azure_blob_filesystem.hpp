@@ -17,6 +17,9 @@ public:
 	Azure::Storage::Blobs::BlobContainerClient GetBlobContainerClient(const std::string &blobContainerName) const;
 	~AzureBlobContextState() override = default;
 
+protected:
+	std::function<void()> GetWarmUpRequest(const std::string &container) const override;
+
 private:
 	Azure::Storage::Blobs::BlobServiceClient service_client;
 };
@@ -29,12 +32,19 @@ public:
 	                           const AzureReadOptions &read_options, Azure::Storage::Blobs::BlobClient blob_client);
 	~AzureBlobStorageFileHandle() override = default;
 
+	string GetUrl() const override {
+		return blob_client.GetUrl();
+	}
+
 public:
 	Azure::Storage::Blobs::BlobClient blob_client;
 };
 
 class AzureBlobStorageFileSystem : public AzureStorageFileSystem {
 public:
+	explicit AzureBlobStorageFileSystem(BufferManager &buffer_manager) : AzureStorageFileSystem(buffer_manager) {
+	}
+
 	vector<string> Glob(const string &path, FileOpener *opener = nullptr) override;
 
 	// FS methods
@@ -65,6 +75,9 @@ protected:
 	                                         optional_ptr<FileOpener> opener) override;
 
 	void ReadRange(AzureFileHandle &handle, idx_t file_offset, char *buffer_out, idx_t buffer_out_len) override;
+	std::unique_ptr<Azure::Core::IO::BodyStream> OpenReadStream(AzureFileHandle &handle, idx_t file_offset,
+	                                                            idx_t length,
+	                                                            const Azure::Core::Context &context) override;
 };
 
 } // namespace duckdb
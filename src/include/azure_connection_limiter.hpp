@@ -0,0 +1,51 @@
+#pragma once
+
+#include "duckdb/common/file_opener.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+#include <azure/core/context.hpp>
+#include <condition_variable>
+
+namespace duckdb {
+
+//! Bounds the number of requests in flight, and therefore of open connections, per host for all the queries of a
+//! database. A slot is held from the moment a request is sent until its response body has been received, except for
+//! the downloads opened with `OpenBodyContext`. The connections themselves are pooled by the SDK curl transport for
+//! the whole process, only their number per host is bounded here.
+class AzureConnectionLimiter : public ObjectCacheEntry {
+public:
+	static string ObjectType() {
+		return "azure_connection_limiter";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+	//! Returns the limiter of the database with its limit set to `max_connections_per_host`, nullptr if there is no
+	//! database
+	static shared_ptr<AzureConnectionLimiter> TryGet(optional_ptr<FileOpener> opener, idx_t max_connections_per_host);
+
+	//! Context of a download whose body is left open between reads (e.g. the stream of a cursor). Its slot is released
+	//! once the response headers are received: the thread reading it sends other requests in the meantime, it would
+	//! otherwise wait for its own slot
+	static Azure::Core::Context OpenBodyContext();
+	//! Whether the slot of a request sent with `context` is released on the response headers
+	static bool IsOpenBody(const Azure::Core::Context &context);
+
+public:
+	//! 0 for no limit
+	void SetMaxConnectionsPerHost(idx_t max_connections);
+	//! Blocks until a connection to `host` is available, throws if `context` is cancelled in the meantime
+	void Acquire(const string &host, const Azure::Core::Context &context);
+	void Release(const string &host);
+
+private:
+	mutex lock;
+	std::condition_variable released;
+	idx_t max_connections_per_host = 0;
+	unordered_map<string, idx_t> in_use;
+};
+
+} // namespace duckdb
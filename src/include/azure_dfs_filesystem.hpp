@@ -19,6 +19,9 @@ public:
 	Azure::Storage::Files::DataLake::DataLakeFileSystemClient
 	GetDfsFileSystemClient(const std::string &file_system_name) const;
 
+protected:
+	std::function<void()> GetWarmUpRequest(const std::string &container) const override;
+
 private:
 	Azure::Storage::Files::DataLake::DataLakeServiceClient service_client;
 };
@@ -32,12 +35,19 @@ public:
 	                          Azure::Storage::Files::DataLake::DataLakeFileClient client);
 	~AzureDfsStorageFileHandle() override = default;
 
+	string GetUrl() const override {
+		return file_client.GetUrl();
+	}
+
 public:
 	Azure::Storage::Files::DataLake::DataLakeFileClient file_client;
 };
 
 class AzureDfsStorageFileSystem : public AzureStorageFileSystem {
 public:
+	explicit AzureDfsStorageFileSystem(BufferManager &buffer_manager) : AzureStorageFileSystem(buffer_manager) {
+	}
+
 	vector<string> Glob(const string &path, FileOpener *opener = nullptr) override;
 
 	bool CanHandleFile(const string &fpath) override;
@@ -65,6 +75,9 @@ protected:
 	                                         optional_ptr<FileOpener> opener) override;
 
 	void ReadRange(AzureFileHandle &handle, idx_t file_offset, char *buffer_out, idx_t buffer_out_len) override;
+	std::unique_ptr<Azure::Core::IO::BodyStream> OpenReadStream(AzureFileHandle &handle, idx_t file_offset,
+	                                                            idx_t length,
+	                                                            const Azure::Core::Context &context) override;
 };
 
 } // namespace duckdb
@@ -1,31 +1,80 @@
 #pragma once
 
+#include "azure_http_state.hpp"
+#include "azure_io_executor.hpp"
+#include "azure_io_scheduler.hpp"
 #include "azure_parsed_url.hpp"
+#include "azure_read_buffer_pool.hpp"
 #include "duckdb/common/assert.hpp"
+#include "duckdb/common/exception.hpp"
 #include "duckdb/common/file_opener.hpp"
 #include "duckdb/common/shared_ptr.hpp"
 #include "duckdb/common/file_system.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
 #include "duckdb/main/client_context_state.hpp"
+#include <azure/core/context.hpp>
 #include <azure/core/datetime.hpp>
+#include <azure/core/io/body_stream.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <ctime>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <thread>
 
 namespace duckdb {
+class BufferManager;
 
 struct AzureReadOptions {
 	int32_t transfer_concurrency = 5;
 	int64_t transfer_chunk_size = 1 * 1024 * 1024;
 	idx_t buffer_size = 1 * 1024 * 1024;
+	bool streaming = false;
+	idx_t prefetch_depth = 0;
+	//! Share the identical reads in flight at the same time, see AzureSingleFlight
+	bool deduplicate_reads = true;
+	//! Send the ETag loaded when a file is opened with its reads (If-Match), so they fail rather than mix the content
+	//! of two versions when the file is overwritten meanwhile
+	bool pin_version = true;
+	//! Read-ahead used for compressed files (.gz, .zst) when `prefetch_depth` is not set, so downloading the next
+	//! buffers overlaps with the decompression of the current one
+	idx_t compressed_prefetch_depth = DEFAULT_COMPRESSED_PREFETCH_DEPTH;
+
+	static constexpr idx_t DEFAULT_COMPRESSED_PREFETCH_DEPTH = 2;
+};
+
+//! Metadata of a remote file, as loaded when the file is opened
+struct AzureFileMetadata {
+	idx_t length;
+	time_t last_modified;
+	string etag;
 };
 
 class AzureContextState : public ClientContextState {
 public:
 	const AzureReadOptions read_options;
+	//! Query the context has been created for, its operations are scheduled on behalf of it
+	transaction_t query_id = MAXIMUM_QUERY_ID;
 
 public:
+	//! Cancels the warm-up requests that have not started and waits for the others
+	~AzureContextState() override;
+
 	virtual bool IsValid() const;
 	void QueryEnd() override;
 
+	//! Files opened through this context share their metadata, so opening the same file again (e.g. one handle per
+	//! reading thread) does not need a new request
+	bool TryGetFileMetadata(const string &path, AzureFileMetadata &result);
+	void SetFileMetadata(const string &path, const AzureFileMetadata &metadata);
+
+	//! Sends `connection_count` concurrent requests to `container` in the background, so that the first reads find
+	//! the endpoint resolved, pooled connections open and the authentication token fetched. Called as soon as the
+	//! context is created, before the first file of the query is opened. Nothing is sent without I/O threads
+	void WarmUp(const string &container, idx_t connection_count);
+
 	template <class TARGET>
 	TARGET &As() {
 		D_ASSERT(dynamic_cast<TARGET *>(this));
@@ -40,17 +89,114 @@ public:
 protected:
 	AzureContextState(const AzureReadOptions &read_options);
 
+	//! A cheap request to the container whose result is ignored. It must not reference the context, which may be
+	//! destroyed before it completes
+	virtual std::function<void()> GetWarmUpRequest(const string &container) const = 0;
+
 protected:
 	bool is_valid;
+
+private:
+	mutex file_metadata_lock;
+	unordered_map<string, AzureFileMetadata> file_metadata;
+	vector<shared_ptr<AzureIOTask>> warm_up_requests;
 };
 
 class AzureStorageFileSystem;
 
+//! Consecutive prefetch buffers filled in order by a single background read. Without streaming a batch is a single
+//! buffer fetched with a ranged read. With streaming, the buffers of a batch are filled from one download and each of
+//! them is handed to the reader as soon as it is complete, so one request on one I/O thread keeps several buffers of
+//! read-ahead in flight.
+class AzurePrefetchBatch {
+public:
+	explicit AzurePrefetchBatch(idx_t buffer_count);
+
+	//! Read filling the buffers, submitted to the AzureIOExecutor
+	shared_ptr<AzureIOTask> task;
+	const idx_t buffer_count;
+	//! Set when the cursor gives up on the batch, the read stops after the buffer it is filling
+	std::atomic<bool> cancelled;
+
+public:
+	void SetFilled(idx_t count);
+	//! The read is over, after filling `count` buffers or failing with `error`
+	void Finish(idx_t count, std::exception_ptr error);
+	//! Wait until the buffer at `index` is filled, rethrows the error of the read. The read must have started
+	void WaitFilled(idx_t index);
+	idx_t FilledCount();
+
+private:
+	mutex lock;
+	std::condition_variable changed;
+	idx_t filled_count = 0;
+	bool finished = false;
+	std::exception_ptr error;
+};
+
+//! A buffer filled in the background, ahead of the sequential reads of a cursor
+struct AzurePrefetch {
+	idx_t offset;
+	idx_t length;
+	AzureReadBuffer buffer;
+	shared_ptr<AzurePrefetchBatch> batch;
+	//! Position of the buffer in its batch
+	idx_t batch_index;
+};
+
+//! State of a sequential reader of a file. A handle has one, handles opened for parallel access have one per reading
+//! thread so each thread buffers, streams and prefetches its own segment of the file.
+struct AzureReadCursor {
+	// Read buffer, lazily taken from the file system buffer pool on the first buffered read
+	AzureReadBuffer read_buffer;
+	// Read info
+	idx_t buffer_available = 0;
+	idx_t buffer_idx = 0;
+	idx_t file_offset = 0;
+	idx_t buffer_start = 0;
+	idx_t buffer_end = 0;
+	//! Bytes of the read buffer that have been copied out, counted from its start
+	idx_t buffer_consumed = 0;
+
+	// Streaming download, used when `read_options.streaming` is set and the cursor is read sequentially
+	std::unique_ptr<Azure::Core::IO::BodyStream> read_stream;
+	idx_t read_stream_offset = 0;
+	//! End offset of the last read, used to detect sequential access
+	idx_t sequential_read_end = 0;
+	//! Number of contiguous reads up to the last one, only maintained for the thread cursors
+	idx_t sequential_read_count = 0;
+
+	// Read-ahead
+	std::deque<AzurePrefetch> prefetches;
+
+	//! Wait for the in flight prefetches and give their buffers back to the pool, returns the number of bytes they
+	//! fetched for nothing
+	idx_t CancelPrefetches(AzureReadBufferPool &pool);
+	//! Forget the content of the read buffer, returns the number of bytes of it that were never read
+	idx_t DiscardBuffer();
+	//! Give the read buffer back to the pool, returns the number of bytes of it that were never read
+	idx_t ReleaseBuffer(AzureReadBufferPool &pool);
+	//! Release everything the cursor holds, returns the number of bytes that were fetched but never read
+	idx_t Reset(AzureReadBufferPool &pool);
+};
+
 class AzureFileHandle : public FileHandle {
 public:
+	~AzureFileHandle() override;
 	virtual bool PostConstruct();
-	void Close() override {
-	}
+	void Close() override;
+
+	//! Allocate the read buffer of a cursor if it has not been done yet, returns false if the memory limit does not
+	//! allow it
+	bool InitializeReadBuffer(AzureReadCursor &read_cursor);
+	//! Cursor of the calling thread, only used by handles opened for parallel access
+	AzureReadCursor &GetThreadCursor();
+	//! Account for bytes that were fetched in a buffer but never read
+	void AddWastedBytes(idx_t bytes);
+	//! Query on behalf of which the handle performs its I/O
+	transaction_t QueryId() const;
+	//! URL of the remote file
+	virtual string GetUrl() const = 0;
 
 protected:
 	AzureFileHandle(AzureStorageFileSystem &fs, string path, FileOpenFlags flags, const AzureReadOptions &read_options);
@@ -61,21 +207,32 @@ public:
 	// File info
 	idx_t length;
 	time_t last_modified;
+	//! Version of the file the handle reads, empty if unknown
+	string etag;
 
-	// Read buffer
-	duckdb::unique_ptr<data_t[]> read_buffer;
-	// Read info
-	idx_t buffer_available;
-	idx_t buffer_idx;
+	// Position of the handle, used by the reads that do not specify a location
 	idx_t file_offset;
-	idx_t buffer_start;
-	idx_t buffer_end;
+	// Read state of the handle
+	AzureReadCursor cursor;
+	// Read-ahead, number of buffers fetched in the background ahead of the sequential reads
+	idx_t prefetch_depth;
 
+	//! Context the handle has been opened with
+	shared_ptr<AzureContextState> storage_context;
+	//! I/O counters reported by EXPLAIN ANALYZE, only set when `azure_http_stats` is enabled
+	shared_ptr<AzureHTTPState> http_state;
+	shared_ptr<AzureFileIOStats> io_stats;
 	const AzureReadOptions read_options;
+
+private:
+	mutex thread_cursors_lock;
+	unordered_map<std::thread::id, duckdb::unique_ptr<AzureReadCursor>> thread_cursors;
 };
 
 class AzureStorageFileSystem : public FileSystem {
 public:
+	explicit AzureStorageFileSystem(BufferManager &buffer_manager);
+
 	// FS methods
 	duckdb::unique_ptr<FileHandle> OpenFile(const string &path, FileOpenFlags flags,
 	                                        optional_ptr<FileOpener> opener = nullptr) override;
@@ -98,10 +255,45 @@ public:
 
 	bool LoadFileInfo(AzureFileHandle &handle);
 
+	AzureReadBufferPool &GetReadBufferPool() {
+		return read_buffer_pool;
+	}
+
 protected:
 	virtual duckdb::unique_ptr<AzureFileHandle> CreateHandle(const string &path, FileOpenFlags flags,
 	                                                         optional_ptr<FileOpener> opener) = 0;
 	virtual void ReadRange(AzureFileHandle &handle, idx_t file_offset, char *buffer_out, idx_t buffer_out_len) = 0;
+	//! ScheduleReadRange, shared with the identical reads in flight when `deduplicate_reads` is set
+	void FetchRange(AzureFileHandle &handle, idx_t file_offset, char *buffer_out, idx_t buffer_out_len,
+	                AzureIOPriority priority = AzureIOPriority::READ);
+	//! ReadRange scheduled by the AzureIOScheduler, accounting for the request in the I/O stats of the handle
+	void ScheduleReadRange(AzureFileHandle &handle, idx_t file_offset, char *buffer_out, idx_t buffer_out_len,
+	                       AzureIOPriority priority);
+	//! ReadRange of `chunk_count` chunks, up to `transfer_concurrency` of them in parallel on the AzureIOExecutor
+	void ReadChunks(AzureFileHandle &handle, idx_t file_offset, char *buffer_out, idx_t buffer_out_len,
+	                idx_t chunk_size, idx_t chunk_count);
+	//! Open a download of `length` bytes of the file from `file_offset`, the body is consumed as it is read
+	virtual std::unique_ptr<Azure::Core::IO::BodyStream> OpenReadStream(AzureFileHandle &handle, idx_t file_offset,
+	                                                                    idx_t length,
+	                                                                    const Azure::Core::Context &context) = 0;
+	//! Read of the handle content, Read accounts the time spent in it as blocked time
+	void ReadInternal(AzureFileHandle &handle, char *buffer, idx_t nr_bytes, idx_t location);
+	//! Buffered read through a cursor
+	void ReadBuffered(AzureFileHandle &handle, AzureReadCursor &cursor, char *buffer, idx_t nr_bytes, idx_t location);
+	//! Read used by the cursors, serves the data from the cursor stream when possible
+	void ReadSequential(AzureFileHandle &handle, AzureReadCursor &cursor, idx_t file_offset, char *buffer_out,
+	                    idx_t buffer_out_len);
+	//! Swap the next prefetched buffer in as the cursor read buffer, returns false if there is none for the
+	//! current offset
+	bool ReadFromPrefetch(AzureFileHandle &handle, AzureReadCursor &cursor);
+	//! Start background reads until `prefetch_depth` buffers are in flight after the cursor read buffer
+	void SchedulePrefetches(AzureFileHandle &handle, AzureReadCursor &cursor);
+	//! Submit the read of the last `buffers.size()` prefetches of the cursor, which start at `file_offset`
+	void StartPrefetchBatch(AzureFileHandle &handle, AzureReadCursor &cursor, idx_t file_offset,
+	                        vector<std::pair<char *, idx_t>> buffers);
+	//! Fill the buffers of a batch from `file_offset`, runs on the AzureIOExecutor
+	void FillPrefetchBatch(AzureFileHandle &handle, AzurePrefetchBatch &batch, idx_t file_offset,
+	                       const vector<std::pair<char *, idx_t>> &buffers);
 
 	virtual const string &GetContextPrefix() const = 0;
 	shared_ptr<AzureContextState> GetOrCreateStorageContext(optional_ptr<FileOpener> opener, const string &path,
@@ -110,8 +302,19 @@ protected:
 	                                                           const AzureParsedUrl &parsed_url) = 0;
 
 	virtual void LoadRemoteFileInfo(AzureFileHandle &handle) = 0;
+	//! Error of a read whose If-Match condition failed
+	static IOException FileModifiedException(const AzureFileHandle &handle);
 	static AzureReadOptions ParseAzureReadOptions(optional_ptr<FileOpener> opener);
+
+	//! Contiguous reads a thread cursor serves directly before it starts buffering, so the random accesses of a
+	//! parallel scan (footers, column chunks) are not rounded up to `buffer_size`
+	static constexpr idx_t DIRECT_SEQUENTIAL_READS = 2;
+	//! Reads ending at the end of a file up to this size are scheduled as footer reads
+	static constexpr idx_t FOOTER_READ_SIZE = 1024 * 1024;
 	static time_t ToTimeT(const Azure::DateTime &dt);
+
+protected:
+	AzureReadBufferPool read_buffer_pool;
 };
 
 } // namespace duckdb
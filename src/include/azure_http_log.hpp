@@ -0,0 +1,69 @@
+#pragma once
+
+#include "duckdb/common/file_opener.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/vector.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+namespace duckdb {
+
+class DatabaseInstance;
+
+//! A network attempt made to Azure, as recorded by the AzureHTTPLog
+struct AzureHTTPLogEntry {
+	//! Query during which the client performing the request was created, MAXIMUM_QUERY_ID if unknown
+	transaction_t query_id = MAXIMUM_QUERY_ID;
+	string method;
+	string path;
+	//! Value of the range header, empty if the whole resource was requested
+	string range;
+	//! HTTP status code, 0 if no response was received
+	int32_t status = 0;
+	idx_t bytes_sent = 0;
+	//! Bytes of the response body that were actually read
+	idx_t bytes_received = 0;
+	timestamp_t start_time;
+	timestamp_t end_time;
+	idx_t thread_id = 0;
+	//! 0 for the first attempt of an operation
+	int32_t retry = 0;
+	//! Error raised when no response was received
+	string error;
+};
+
+//! Ring buffer of the most recent requests made to Azure by a database. It is opt-in (setting `azure_http_log_size`)
+//! and is queryable through the `azure_http_log()` table function.
+class AzureHTTPLog : public ObjectCacheEntry {
+public:
+	static string ObjectType() {
+		return "azure_http_log";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+	//! Returns the log of the database when `azure_http_log_size` is set, nullptr otherwise
+	static shared_ptr<AzureHTTPLog> TryGetLog(optional_ptr<FileOpener> opener);
+	//! Registers the `azure_http_log()` table function
+	static void RegisterFunction(DatabaseInstance &instance);
+
+public:
+	void Add(AzureHTTPLogEntry entry);
+	//! Changes the number of kept entries, the most recent ones are kept
+	void Resize(idx_t new_capacity);
+	//! Copy of the entries, oldest first
+	vector<AzureHTTPLogEntry> GetEntries();
+
+private:
+	vector<AzureHTTPLogEntry> GetEntriesInternal();
+
+private:
+	mutex lock;
+	idx_t capacity = 0;
+	vector<AzureHTTPLogEntry> entries;
+	//! Slot to overwrite next once the log is full, i.e. the oldest entry
+	idx_t next_entry = 0;
+};
+
+} // namespace duckdb
@@ -3,10 +3,69 @@
 #include "duckdb/common/atomic.hpp"
 #include "duckdb/common/file_opener.hpp"
 #include "duckdb/common/file_system.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
 #include "duckdb/main/client_context_state.hpp"
 
+#include <thread>
+
 namespace duckdb {
 
+//! Log-linear latency histogram (4 buckets per power of two microseconds). It is lock free so it can be updated from
+//! any thread performing Azure requests.
+class AzureLatencyHistogram {
+public:
+	static constexpr idx_t SUB_BUCKETS = 4;
+	static constexpr idx_t MAX_EXPONENT = 36;
+	static constexpr idx_t BUCKET_COUNT = SUB_BUCKETS * MAX_EXPONENT;
+
+	AzureLatencyHistogram();
+
+public:
+	void Add(idx_t latency_us);
+	void Reset();
+
+	idx_t Count() const {
+		return count;
+	}
+	idx_t Sum() const {
+		return sum;
+	}
+	idx_t Max() const {
+		return max;
+	}
+	//! Upper bound (in microseconds) of the bucket holding the given percentile, percentile is in [0, 100]
+	idx_t Percentile(double percentile) const;
+
+private:
+	static idx_t BucketIndex(idx_t latency_us);
+	static idx_t BucketUpperBound(idx_t bucket);
+
+private:
+	atomic<idx_t> buckets[BUCKET_COUNT];
+	atomic<idx_t> count;
+	atomic<idx_t> sum;
+	atomic<idx_t> max;
+};
+
+//! I/O counters of a remote file, shared by all the handles opened on it during a query
+struct AzureFileIOStats {
+	explicit AzureFileIOStats(string path_p) : path(std::move(path_p)) {
+	}
+
+	const string path;
+	//! Requests made to fetch the content of the file and the bytes they returned
+	atomic<idx_t> request_count {0};
+	atomic<idx_t> bytes_fetched {0};
+	//! Bytes read from the handles, and the part of them that was already buffered when read
+	atomic<idx_t> bytes_read {0};
+	atomic<idx_t> bytes_served_from_buffer {0};
+	//! Bytes fetched in a read buffer that were never read
+	atomic<idx_t> bytes_wasted {0};
+	//! Time spent waiting for the content of the file
+	atomic<idx_t> wait_time_us {0};
+};
+
 class AzureHTTPState : public ClientContextState {
 public:
 	AzureHTTPState() {
@@ -19,6 +78,9 @@ public:
 	static shared_ptr<AzureHTTPState> TryGetState(ClientContext &context);
 	static shared_ptr<AzureHTTPState> TryGetState(optional_ptr<FileOpener> opener);
 
+	//! Counters of a file read during the current query
+	shared_ptr<AzureFileIOStats> GetFileStats(const string &path);
+
 	bool IsEmpty() {
 		return head_count == 0 && get_count == 0 && put_count == 0 && post_count == 0 && total_bytes_received == 0 &&
 		       total_bytes_sent == 0;
@@ -30,12 +92,59 @@ public:
 	atomic<idx_t> post_count {0};
 	atomic<idx_t> total_bytes_received {0};
 	atomic<idx_t> total_bytes_sent {0};
+	//! Bytes fetched in the read buffers of the files that were never read, tuning `azure_read_buffer_size` down
+	//! reduces them
+	atomic<idx_t> total_bytes_wasted {0};
+
+	//! Latency of the requests per method, from the request being sent to the end of its response body
+	AzureLatencyHistogram head_latency;
+	AzureLatencyHistogram get_latency;
+	AzureLatencyHistogram put_latency;
+	AzureLatencyHistogram post_latency;
+	//! Time to first byte (response headers received) of all the requests
+	AzureLatencyHistogram ttfb_latency;
+
+	//! Network attempts, unlike the counters above these include the retries made by the SDK
+	atomic<idx_t> attempt_count {0};
+	atomic<idx_t> retry_count {0};
+	//! Responses received per status code class (1xx responses are counted as 2xx)
+	atomic<idx_t> status_2xx_count {0};
+	atomic<idx_t> status_3xx_count {0};
+	atomic<idx_t> status_4xx_count {0};
+	atomic<idx_t> status_5xx_count {0};
+	//! Responses telling us to slow down (429 Too Many Requests and 503 Server Busy)
+	atomic<idx_t> throttled_count {0};
+	//! Attempts that failed without a response (connection reset, timeout...)
+	atomic<idx_t> transport_error_count {0};
+	//! Stall breakdown of the attempts, summed over all threads: waiting for the response headers (connection, TLS
+	//! handshake and server time, the SDK transport does not report them separately), receiving the response body and
+	//! waiting between attempts
+	atomic<idx_t> attempt_time_us {0};
+	atomic<idx_t> body_time_us {0};
+	atomic<idx_t> backoff_time_us {0};
+
+	//! Time the threads reading Azure files spent blocked in the file system, i.e. not executing the query
+	atomic<idx_t> blocked_time_us {0};
+	void AddBlockedTime(idx_t time_us);
+
+	//! Number of files listed in the profiling information, the ones which fetched the most bytes
+	static constexpr idx_t TOP_FILE_COUNT = 5;
 
 	//! Called by the ClientContext when the current query ends
 	void QueryEnd(ClientContext &context) override {
 		Reset();
 	}
 	void WriteProfilingInformation(std::ostream &ss) override;
+
+private:
+	void WriteFileStats(std::ostream &ss);
+
+private:
+	mutex file_stats_lock;
+	unordered_map<string, shared_ptr<AzureFileIOStats>> file_stats;
+
+	mutex thread_blocked_time_lock;
+	unordered_map<std::thread::id, idx_t> thread_blocked_time_us;
 };
 
 } // namespace duckdb
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "duckdb/common/common.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/shared_ptr.hpp"
+#include "duckdb/common/vector.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <thread>
+
+namespace duckdb {
+
+//! Work submitted to the AzureIOExecutor
+class AzureIOTask {
+public:
+	explicit AzureIOTask(std::function<void()> work);
+
+	//! Run the work on the calling thread, unless another thread has started it or it has been cancelled
+	void TryRun();
+	//! Wait for the work to be done and rethrow its exception. If no thread has started it, it runs on the calling
+	//! thread rather than waiting in the queue, so waiting on a task never deadlocks
+	void Wait();
+	//! Prevent the work from starting, returns false if it has already started (Wait for it to be done)
+	bool Cancel();
+
+private:
+	mutex lock;
+	std::condition_variable done;
+	std::function<void()> work;
+	bool started = false;
+	bool finished = false;
+	std::exception_ptr error;
+};
+
+//! Fixed size pool of threads running the Azure I/O submitted by the file systems (chunks of large reads,
+//! prefetches, hedged requests, connection warm-up). The DuckDB threads only wait for the I/O they need, the SDK never
+//! creates threads of its own and the number of threads blocked on the network stays bounded regardless of the number
+//! of DuckDB threads and open files. The pool is process-wide, it is only resized by an explicit SET of
+//! `azure_io_threads` or `azure_io_thread_pinning`.
+class AzureIOExecutor {
+public:
+	static AzureIOExecutor &Get();
+	//! Stops the threads once they have run the queued tasks
+	~AzureIOExecutor();
+
+	//! Resize the pool, 0 to run the I/O on the threads waiting for it. The threads removed finish their task and
+	//! are joined, the tasks still queued when the pool is emptied run on the calling thread and the delayed ones are
+	//! cancelled
+	void SetThreadCount(idx_t thread_count);
+	//! Pin each thread to a CPU (Linux only)
+	void SetThreadPinning(bool pin_threads);
+	idx_t ThreadCount();
+	shared_ptr<AzureIOTask> Submit(std::function<void()> work);
+	//! Queue the work once `delay` has passed, no thread is blocked in the meantime. Without threads the task only
+	//! runs when it is waited for
+	shared_ptr<AzureIOTask> SubmitAfter(std::chrono::microseconds delay, std::function<void()> work);
+
+	static constexpr idx_t DEFAULT_THREAD_COUNT = 16;
+
+private:
+	AzureIOExecutor() = default;
+
+	void WorkerLoop(idx_t worker_index);
+	//! Start the missing threads, requires `lock`
+	void StartWorkers();
+	//! Move the delayed tasks that are due to the queue, requires `lock`
+	void QueueDueTasks();
+	//! Pin the calling thread to a CPU, or let it run on all of them
+	static void SetCPUAffinity(idx_t worker_index, bool pin);
+
+private:
+	//! Serializes the resizes, which join threads outside of `lock`
+	mutex resize_lock;
+	mutex lock;
+	std::condition_variable work_available;
+	std::deque<shared_ptr<AzureIOTask>> queue;
+	std::multimap<std::chrono::steady_clock::time_point, shared_ptr<AzureIOTask>> delayed;
+	idx_t thread_count = DEFAULT_THREAD_COUNT;
+	bool pin_threads = false;
+	//! Incremented when `pin_threads` changes, so the running threads update their affinity
+	idx_t pinning_generation = 0;
+	//! The worker at index `i` runs while `i < thread_count`, the missing ones are started by Submit
+	vector<std::thread> workers;
+};
+
+} // namespace duckdb
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "duckdb/common/common.hpp"
+#include "duckdb/common/file_opener.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "duckdb/common/vector.hpp"
+
+#include <condition_variable>
+
+namespace duckdb {
+
+//! Priority classes of the Azure I/O, from the most to the least latency critical
+enum class AzureIOPriority : uint8_t {
+	//! File properties and listings, planning waits for them
+	METADATA = 0,
+	//! Small reads at the end of a file (e.g. Parquet footers), needed before a file can be scanned
+	FOOTER = 1,
+	//! Reads a DuckDB thread is blocked on
+	READ = 2,
+	//! Speculative reads ahead of a sequential reader
+	PREFETCH = 3
+};
+
+//! Bounds the number of Azure operations in flight in the process. When the bound is reached, waiting operations are
+//! admitted by priority class, then in favor of the query with the fewest operations in flight (so concurrent queries
+//! share the bandwidth), then in arrival order. Enabled by setting `azure_io_max_concurrency`.
+class AzureIOScheduler {
+public:
+	static constexpr idx_t PRIORITY_COUNT = 4;
+
+	static AzureIOScheduler &Get();
+	//! Query of the opener, used to share the I/O fairly between queries
+	static transaction_t GetQueryId(optional_ptr<FileOpener> opener);
+
+public:
+	//! 0 for no bound
+	void SetMaxConcurrency(idx_t max_concurrency);
+	//! Blocks until an operation of the given priority may start
+	void Acquire(AzureIOPriority priority, transaction_t query_id);
+	void Release(transaction_t query_id);
+
+private:
+	struct Waiter {
+		AzureIOPriority priority;
+		transaction_t query_id;
+		//! Arrival order
+		idx_t ticket;
+		bool admitted;
+	};
+
+	//! Start the waiters that fit in the bound, best first, `lock` must be held
+	void AdmitWaiters();
+
+private:
+	mutex lock;
+	std::condition_variable admitted;
+	idx_t max_concurrency = 0;
+	idx_t running = 0;
+	idx_t next_ticket = 0;
+	vector<Waiter *> waiters;
+	unordered_map<transaction_t, idx_t> running_per_query;
+};
+
+//! An operation admitted by the AzureIOScheduler, from its construction to its destruction
+class AzureIOSlot {
+public:
+	AzureIOSlot(AzureIOPriority priority, transaction_t query_id);
+	~AzureIOSlot();
+
+	AzureIOSlot(const AzureIOSlot &) = delete;
+	AzureIOSlot &operator=(const AzureIOSlot &) = delete;
+
+private:
+	transaction_t query_id;
+};
+
+} // namespace duckdb
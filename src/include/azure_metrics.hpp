@@ -0,0 +1,87 @@
+#pragma once
+
+#include "azure_http_state.hpp"
+#include "azure_io_scheduler.hpp"
+#include "duckdb/common/atomic.hpp"
+#include "duckdb/common/vector.hpp"
+
+namespace duckdb {
+
+class DatabaseInstance;
+
+//! A value of the process metrics, as exposed by `azure_metrics()`
+struct AzureMetricValue {
+	string name;
+	//! Prometheus type: counter, gauge or summary
+	string type;
+	string help;
+	//! Prometheus labels, e.g. `method="GET"`, empty if the metric has none
+	string labels;
+	double value;
+};
+
+//! Cumulative metrics of all the Azure I/O made by the process. Unlike the AzureHTTPState they are never reset and are
+//! always collected, they are read through the `azure_metrics()` table function or exported in the Prometheus text
+//! format by `azure_metrics_export(path)`.
+class AzureMetrics {
+public:
+	//! Index of the method in `request_count`
+	enum class Method : uint8_t { HEAD = 0, GET = 1, PUT = 2, POST = 3, OTHER = 4 };
+	static constexpr idx_t METHOD_COUNT = 5;
+
+	static AzureMetrics &Get();
+	//! Registers the `azure_metrics()` and `azure_metrics_export(path)` table functions
+	static void RegisterFunctions(DatabaseInstance &instance);
+
+public:
+	//! Network attempts per method, retries included
+	atomic<idx_t> request_count[METHOD_COUNT];
+	atomic<idx_t> retry_count {0};
+	atomic<idx_t> requests_in_flight {0};
+	//! Responses per status class, 1xx responses are counted as 2xx
+	atomic<idx_t> status_2xx_count {0};
+	atomic<idx_t> status_3xx_count {0};
+	atomic<idx_t> status_4xx_count {0};
+	atomic<idx_t> status_5xx_count {0};
+	atomic<idx_t> throttled_count {0};
+	atomic<idx_t> transport_error_count {0};
+	atomic<idx_t> bytes_sent {0};
+	atomic<idx_t> bytes_received {0};
+	//! Bytes fetched in read buffers that were never read
+	atomic<idx_t> bytes_wasted {0};
+	//! Latency of the attempts, up to the end of their response body
+	AzureLatencyHistogram request_latency;
+	//! Time to the response headers of ranged reads, the hedging delay is derived from it
+	AzureLatencyHistogram range_response_latency;
+	//! Ranged reads for which a duplicate request was sent, and the ones the duplicate answered first
+	atomic<idx_t> hedged_request_count {0};
+	atomic<idx_t> hedge_win_count {0};
+	//! Attempts abandoned after `azure_request_timeout_ms`
+	atomic<idx_t> timeout_count {0};
+	//! Time requests waited for the rate limiter of their storage account
+	atomic<idx_t> rate_limit_wait_us {0};
+	//! Reads served by an identical read in flight instead of a request of their own
+	atomic<idx_t> deduplicated_read_count {0};
+	//! Background reads started to fill read-ahead buffers
+	atomic<idx_t> prefetch_count {0};
+	//! Time operations waited for the AzureIOScheduler, per AzureIOPriority
+	atomic<idx_t> io_queue_wait_us[AzureIOScheduler::PRIORITY_COUNT];
+
+	//! File metadata served by the context cache instead of a request
+	atomic<idx_t> metadata_cache_hits {0};
+	atomic<idx_t> metadata_cache_misses {0};
+	//! Read buffers reused from the pool instead of being allocated
+	atomic<idx_t> read_buffer_pool_hits {0};
+	atomic<idx_t> read_buffer_pool_misses {0};
+
+public:
+	//! Point in time copy of all the metrics
+	vector<AzureMetricValue> Snapshot() const;
+	//! Metrics in the Prometheus text exposition format
+	string ToPrometheus() const;
+
+private:
+	AzureMetrics();
+};
+
+} // namespace duckdb
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "duckdb/common/atomic.hpp"
+#include "duckdb/common/file_opener.hpp"
+#include "duckdb/common/file_system.hpp"
+
+#include <azure/core/http/transport.hpp>
+#include <memory>
+#include <string>
+
+namespace duckdb {
+
+struct AzureMockTransportOptions {
+	//! Local directory serving as the storage account, containers are its sub directories
+	string root = ".";
+	//! Delay added before each response
+	idx_t latency_ms = 0;
+	//! Maximum speed at which response bodies are read, 0 for unlimited
+	idx_t bandwidth = 0;
+	//! Every Nth request is answered with a 503 ServerBusy, 0 to disable
+	idx_t throttle_every = 0;
+	//! Every Nth request fails with a connection reset, 0 to disable
+	idx_t reset_every = 0;
+	//! Every Nth request sees the files as modified right before it (newer last modified time and ETag), 0 to disable
+	idx_t modify_every = 0;
+};
+
+//! An in-process transport answering the subset of the Blob and DFS REST APIs used by the extension (HEAD, ranged
+//! GET, List Blobs and List Paths) from a local directory. Latency, bandwidth, throttling, connection resets and
+//! concurrent modifications are injected deterministically so tests and benchmarks of the I/O path can run offline.
+//! Selected with `SET azure_transport_option_type = 'mock'`, configured by the `azure_mock_*` settings.
+class AzureMockTransport : public Azure::Core::Http::HttpTransport {
+public:
+	//! `fs` is the file system of the connection, so the files served are subject to its access restrictions
+	//! (`enable_external_access`, `allowed_directories`). The transport must not outlive the connection
+	AzureMockTransport(FileSystem &fs, AzureMockTransportOptions options);
+
+	static AzureMockTransportOptions ParseOptions(optional_ptr<FileOpener> opener);
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Context const &context) override;
+
+private:
+	std::unique_ptr<Azure::Core::Http::RawResponse> GetBlob(Azure::Core::Http::Request &request, const string &path,
+	                                                        idx_t request_number);
+	std::unique_ptr<Azure::Core::Http::RawResponse> ListBlobs(Azure::Core::Http::Request &request,
+	                                                          const string &container);
+	std::unique_ptr<Azure::Core::Http::RawResponse> ListPaths(Azure::Core::Http::Request &request,
+	                                                          const string &file_system);
+
+	//! Files under `directory`, recursively, relative to `prefix`
+	void ListFilesRecursive(const string &directory, const string &prefix, vector<string> &result,
+	                        bool include_directories);
+
+private:
+	AzureMockTransportOptions options;
+	FileSystem &fs;
+	atomic<idx_t> request_count;
+};
+
+} // namespace duckdb
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "duckdb/common/common.hpp"
+#include "duckdb/common/mutex.hpp"
+
+#include <chrono>
+#include <functional>
+
+namespace duckdb {
+
+//! Limits of an AzureRateLimiter, 0 for unlimited
+struct AzureRateLimits {
+	idx_t requests_per_second = 0;
+	idx_t bytes_per_second = 0;
+	//! Lower the rates when the account throttles us, and raise them back while it does not (AIMD)
+	bool adaptive = true;
+
+	bool operator==(const AzureRateLimits &other) const {
+		return requests_per_second == other.requests_per_second && bytes_per_second == other.bytes_per_second &&
+		       adaptive == other.adaptive;
+	}
+};
+
+//! Token buckets bounding the requests and bytes per second sent to a storage account by the whole process. Storage
+//! accounts have request rate and bandwidth limits, staying under them avoids the storms of 503 ServerBusy that the
+//! retries of parallel scans otherwise cause.
+class AzureRateLimiter {
+public:
+	AzureRateLimiter(string account_name, const AzureRateLimits &limits);
+
+	//! Limiter of `account_name` for the given limits. The sessions configuring the same limits share their budget,
+	//! a session setting other limits gets its own limiter rather than changing the one of the other sessions
+	static AzureRateLimiter &Get(const string &account_name, const AzureRateLimits &limits);
+	//! Calls `callback` with every limiter of the process
+	static void ForEach(const std::function<void(AzureRateLimiter &)> &callback);
+
+public:
+	//! Blocks until a request of `bytes` bytes can be sent, returns the time waited in microseconds
+	idx_t Acquire(idx_t bytes);
+	//! Adapts the rates to the status of a response
+	void OnResponse(int32_t status);
+	//! Current fraction of the configured rates, lowered on throttling
+	double RateFactor();
+	const string &AccountName() const {
+		return account_name;
+	}
+	const AzureRateLimits &Limits() const {
+		return limits;
+	}
+
+	//! Fraction of the rates kept when throttled
+	static constexpr double DECREASE_FACTOR = 0.5;
+	//! Fraction of the configured rates recovered per second of successful requests. The increase depends on the time
+	//! and not on the number of requests, a fast scan would otherwise undo a decrease within a fraction of a second
+	static constexpr double INCREASE_PER_SECOND = 0.05;
+	static constexpr double MINIMUM_RATE_FACTOR = 0.05;
+
+private:
+	struct TokenBucket {
+		double tokens = 0;
+		std::chrono::steady_clock::time_point last_refill = std::chrono::steady_clock::now();
+
+		//! Time to wait before `cost` can be taken at `rate` per second, takes it if 0
+		std::chrono::microseconds TryTake(double cost, double rate);
+	};
+
+	mutex lock;
+	const string account_name;
+	const AzureRateLimits limits;
+	double rate_factor = 1;
+	//! Throttling responses arrive in bursts, the rates are only decreased once per burst
+	std::chrono::steady_clock::time_point last_decrease;
+	//! Time up to which the rates have been increased
+	std::chrono::steady_clock::time_point last_increase;
+	TokenBucket requests;
+	TokenBucket bytes;
+};
+
+} // namespace duckdb
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/typedefs.hpp"
+#include "duckdb/common/vector.hpp"
+#include "duckdb/storage/buffer/buffer_handle.hpp"
+
+namespace duckdb {
+
+class BufferManager;
+
+//! A read buffer handed out by the AzureReadBufferPool, the memory is owned by DuckDB's buffer manager
+struct AzureReadBuffer {
+	BufferHandle handle;
+	idx_t size = 0;
+
+	bool IsValid() const {
+		return handle.IsValid();
+	}
+	data_ptr_t Ptr() const {
+		return handle.Ptr();
+	}
+};
+
+//! Recycles the read buffers of the sequential Azure file handles. Opening thousands of small files (e.g. a glob over
+//! CSV files) would otherwise allocate and free a full read buffer per file.
+//! Buffers are allocated through the buffer manager so they count against the `memory_limit`.
+class AzureReadBufferPool {
+public:
+	static constexpr idx_t DEFAULT_MAX_POOLED_BYTES = 16 * 1024 * 1024;
+
+	explicit AzureReadBufferPool(BufferManager &buffer_manager, idx_t max_pooled_bytes = DEFAULT_MAX_POOLED_BYTES);
+
+public:
+	//! Returns a buffer of `size` bytes, reusing an idle one if available. Throws when the memory limit is reached.
+	AzureReadBuffer Acquire(idx_t size);
+	//! Same as Acquire but returns an invalid buffer instead of throwing when the memory limit is reached, callers are
+	//! expected to degrade (read unbuffered, prefetch less...)
+	AzureReadBuffer TryAcquire(idx_t size);
+	//! Gives a buffer back to the pool, it is freed if the pool is already full
+	void Release(AzureReadBuffer buffer);
+	//! Frees all idle buffers
+	void Clear();
+
+private:
+	AzureReadBuffer TryReuse(idx_t size);
+	AzureReadBuffer Allocate(idx_t size);
+
+private:
+	BufferManager &buffer_manager;
+
+	mutex lock;
+	vector<AzureReadBuffer> idle_buffers;
+	idx_t pooled_bytes;
+	const idx_t max_pooled_bytes;
+};
+
+} // namespace duckdb
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "duckdb/common/common.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/shared_ptr.hpp"
+#include "duckdb/common/unique_ptr.hpp"
+#include "duckdb/common/unordered_map.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+
+namespace duckdb {
+
+//! Shares the identical reads that are in flight at the same time in the process, e.g. the footers of a Parquet file
+//! opened by several threads or queries at once: the first read goes to the network, the ones arriving while it is in
+//! flight wait for it and get a copy of its result. Nothing is kept once a read is done, this is not a cache.
+class AzureSingleFlight {
+public:
+	static AzureSingleFlight &Get();
+
+	//! Fill `buffer_out` with `read`, or with the result of the read of `key` in flight. `key` must identify the
+	//! version of the blob and the range read. Returns true if the result of another read has been used
+	bool Read(const string &key, char *buffer_out, idx_t buffer_out_len, const std::function<void()> &read);
+
+private:
+	struct Flight {
+		mutex lock;
+		std::condition_variable done;
+		bool finished = false;
+		//! Reads waiting for this one, the result is only copied when there are some. Protected by the map lock
+		idx_t follower_count = 0;
+		unsafe_unique_array<char> data;
+		std::exception_ptr error;
+	};
+
+	mutex lock;
+	unordered_map<string, shared_ptr<Flight>> flights;
+};
+
+} // namespace duckdb
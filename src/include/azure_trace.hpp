@@ -0,0 +1,63 @@
+#pragma once
+
+#include "duckdb/common/file_opener.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/vector.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+#include <utility>
+
+namespace duckdb {
+
+//! A storage operation, exported as an OpenTelemetry span
+struct AzureSpan {
+	string name;
+	//! Spans of the same query share their trace id
+	string trace_id;
+	string span_id;
+	int64_t start_time_ns = 0;
+	int64_t end_time_ns = 0;
+	vector<std::pair<string, string>> string_attributes;
+	vector<std::pair<string, int64_t>> int_attributes;
+	//! Set when the operation failed
+	string error;
+};
+
+//! Appends spans to a file in the OTLP/JSON format (one `ExportTraceServiceRequest` per line), as read by the file
+//! receiver of the OpenTelemetry collector. Enabled by setting `azure_trace_file`. The file is opened through the file
+//! system of the connection, so `enable_external_access` applies, and its exporter is shared by the connections of
+//! the database.
+class AzureTraceExporter : public ObjectCacheEntry {
+public:
+	AzureTraceExporter(string path, unique_ptr<FileHandle> handle);
+
+	static string ObjectType() {
+		return "azure_trace_exporter";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+	//! Returns the exporter of the file set in `azure_trace_file`, nullptr if tracing is disabled. Throws if the file
+	//! cannot be opened, or if spans could not be written to it since the last call
+	static shared_ptr<AzureTraceExporter> TryGetExporter(optional_ptr<FileOpener> opener);
+	//! Trace id of the spans of a query, random when the query is unknown
+	static string TraceId(transaction_t query_id);
+	static string NewSpanId();
+	static int64_t NowNanoseconds();
+
+public:
+	//! Never throws, spans are also exported when a response body is destroyed. A failure is reported by the next
+	//! TryGetExporter instead
+	void Export(const AzureSpan &span);
+
+private:
+	mutex lock;
+	const string path;
+	unique_ptr<FileHandle> handle;
+	//! Error of the first span that could not be written since the last TryGetExporter, empty if none
+	string write_error;
+};
+
+} // namespace duckdb
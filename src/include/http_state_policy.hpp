@@ -1,11 +1,18 @@
 #pragma once
 
 #include "duckdb/common/shared_ptr.hpp"
+#include "azure_connection_limiter.hpp"
+#include "azure_http_log.hpp"
 #include "azure_http_state.hpp"
+#include "azure_metrics.hpp"
+#include "azure_rate_limiter.hpp"
+#include "azure_trace.hpp"
 #include <azure/core/context.hpp>
 #include <azure/core/http/http.hpp>
 #include <azure/core/http/policies/policy.hpp>
 #include <azure/core/http/raw_response.hpp>
+#include <azure/core/http/transport.hpp>
+#include <chrono>
 #include <memory>
 
 namespace duckdb {
@@ -24,4 +31,132 @@ private:
 	shared_ptr<AzureHTTPState> http_state;
 };
 
+//! Companion of the HttpStatePolicy registered in the `PerRetryPolicies`, it sees every network attempt and accounts
+//! for retries, status codes, throttling and time spent backing off between attempts
+class HttpRetryStatePolicy : public Azure::Core::Http::Policies::HttpPolicy {
+public:
+	HttpRetryStatePolicy(shared_ptr<AzureHTTPState> http_state);
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+	                                                     Azure::Core::Context const &context) const override;
+
+	std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> Clone() const override;
+
+private:
+	shared_ptr<AzureHTTPState> http_state;
+};
+
+//! Accounts for every network attempt in the process wide AzureMetrics, registered in the `PerRetryPolicies`
+class HttpMetricsPolicy : public Azure::Core::Http::Policies::HttpPolicy {
+public:
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+	                                                     Azure::Core::Context const &context) const override;
+
+	std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> Clone() const override;
+};
+
+//! Records every network attempt in the AzureHTTPLog, registered in the `PerRetryPolicies`
+class HttpLogPolicy : public Azure::Core::Http::Policies::HttpPolicy {
+public:
+	HttpLogPolicy(shared_ptr<AzureHTTPLog> http_log, transaction_t query_id);
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+	                                                     Azure::Core::Context const &context) const override;
+
+	std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> Clone() const override;
+
+private:
+	shared_ptr<AzureHTTPLog> http_log;
+	transaction_t query_id;
+};
+
+//! Exports a span per storage operation (retries included) to the AzureTraceExporter, registered in the
+//! `PerOperationPolicies`
+class HttpTracePolicy : public Azure::Core::Http::Policies::HttpPolicy {
+public:
+	HttpTracePolicy(shared_ptr<AzureTraceExporter> exporter, transaction_t query_id);
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+	                                                     Azure::Core::Context const &context) const override;
+
+	std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> Clone() const override;
+
+private:
+	shared_ptr<AzureTraceExporter> exporter;
+	transaction_t query_id;
+};
+
+//! Holds a slot of the AzureConnectionLimiter for each network attempt until its response body has been received, or
+//! only until its headers for the downloads sent with `AzureConnectionLimiter::OpenBodyContext`.
+//! Registered after the hedging policy so that duplicate requests hold a slot too, and before the timeout policy so
+//! that waiting for a slot does not count against the timeout of an attempt. The metrics and log policies come
+//! first, the latency they record includes the wait.
+class HttpConnectionLimitPolicy : public Azure::Core::Http::Policies::HttpPolicy {
+public:
+	HttpConnectionLimitPolicy(shared_ptr<AzureConnectionLimiter> limiter);
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+	                                                     Azure::Core::Context const &context) const override;
+
+	std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> Clone() const override;
+
+private:
+	shared_ptr<AzureConnectionLimiter> limiter;
+};
+
+//! Abandons a network attempt whose response headers have not been received after `timeout`, so the retry policy
+//! sends a new one instead of waiting on a stalled connection. Registered in the `PerRetryPolicies`
+class HttpTimeoutPolicy : public Azure::Core::Http::Policies::HttpPolicy {
+public:
+	HttpTimeoutPolicy(std::chrono::milliseconds timeout);
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+	                                                     Azure::Core::Context const &context) const override;
+
+	std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> Clone() const override;
+
+private:
+	std::chrono::milliseconds timeout;
+};
+
+//! Sends a duplicate of a ranged read whose response headers take longer than the p95 of the process, and uses the
+//! response that arrives first. The original request is sent on the calling thread, the duplicate is a delayed task of
+//! the AzureIOExecutor that is cancelled if the original one is answered in time. Both go through the policies that
+//! follow this one (connection limit, timeout, SDK logging), the policies before it see a hedged read as one attempt
+class HttpHedgingPolicy : public Azure::Core::Http::Policies::HttpPolicy {
+public:
+	HttpHedgingPolicy();
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+	                                                     Azure::Core::Context const &context) const override;
+
+	std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> Clone() const override;
+
+	//! Ranged reads observed before hedging starts, the p95 is meaningless before that
+	static constexpr idx_t MINIMUM_SAMPLES = 50;
+};
+
+//! Makes each network attempt wait for the AzureRateLimiter of its storage account, and feeds it the response status
+//! so it adapts to throttling. Registered first in the `PerRetryPolicies`
+class HttpRateLimitPolicy : public Azure::Core::Http::Policies::HttpPolicy {
+public:
+	HttpRateLimitPolicy(AzureRateLimits limits);
+
+	std::unique_ptr<Azure::Core::Http::RawResponse> Send(Azure::Core::Http::Request &request,
+	                                                     Azure::Core::Http::Policies::NextHttpPolicy next_policy,
+	                                                     Azure::Core::Context const &context) const override;
+
+	std::unique_ptr<Azure::Core::Http::Policies::HttpPolicy> Clone() const override;
+
+private:
+	AzureRateLimits limits;
+};
+
 } // namespace duckdb